@@ -508,6 +508,8 @@ static void ffmpeg_cleanup(int ret)
         if (!ost)
             continue;
 
+        chunk_transcode_uninit(ost);
+
         for (j = 0; j < ost->nb_bitstream_filters; j++)
             av_bsf_free(&ost->bsf_ctx[j]);
         av_freep(&ost->bsf_ctx);
@@ -634,6 +636,21 @@ static void update_benchmark(const char *fmt, ...)
     }
 }
 
+static void print_stage_timing(AVCodecContext *avctx, const char *type,
+                               int file_index, int index)
+{
+    int i;
+
+    for (i = 0; i < AV_CODEC_STAGE_NB; i++) {
+        uint64_t time, count;
+
+        if (avcodec_get_stage_timing(avctx, i, &time, &count) < 0 || !count)
+            continue;
+        av_log(NULL, AV_LOG_INFO, "bench: %s %d.%d %s: %"PRIu64" units in %"PRIu64" runs\n",
+               type, file_index, index, avcodec_stage_name(i), time, count);
+    }
+}
+
 static void close_all_output_streams(OutputStream *ost, OSTFinished this_stream, OSTFinished others)
 {
     int i;
@@ -1791,7 +1808,8 @@ static void flush_encoders(void)
         OutputFile      *of = output_files[ost->file_index];
         int stop_encoding = 0;
 
-        if (!ost->encoding_needed)
+        /* the encoders of the chunks are flushed with them */
+        if (!ost->encoding_needed || ost->chunk_ctx)
             continue;
 
         if (enc->codec_type == AVMEDIA_TYPE_AUDIO && enc->frame_size <= 1)
@@ -1991,6 +2009,14 @@ static void do_streamcopy(InputStream *ist, OutputStream *ost, const AVPacket *p
     }
 #endif
 
+    /* reference the input payload, so that the packet can be queued by the
+     * bitstream filters and the muxer without being copied */
+    if (!opkt.buf && pkt->buf && opkt.data == pkt->data) {
+        opkt.buf = av_buffer_ref(pkt->buf);
+        if (!opkt.buf)
+            exit_program(1);
+    }
+
     output_packet(of, &opkt, ost);
 }
 
@@ -2730,6 +2756,8 @@ static int init_input_stream(int ist_index, char *error, int error_len)
 
         if (!av_dict_get(ist->decoder_opts, "threads", NULL, 0))
             av_dict_set(&ist->decoder_opts, "threads", "auto", 0);
+        if (do_benchmark_all && !av_dict_get(ist->decoder_opts, "stage_timing", NULL, 0))
+            av_dict_set(&ist->decoder_opts, "stage_timing", "1", 0);
         if ((ret = avcodec_open2(ist->dec_ctx, codec, &ist->decoder_opts)) < 0) {
             if (ret == AVERROR_EXPERIMENTAL)
                 abort_codec_experimental(codec, 0);
@@ -3014,6 +3042,8 @@ static int init_output_stream(OutputStream *ost, char *error, int error_len)
         }
         if (!av_dict_get(ost->encoder_opts, "threads", NULL, 0))
             av_dict_set(&ost->encoder_opts, "threads", "auto", 0);
+        if (do_benchmark_all && !av_dict_get(ost->encoder_opts, "stage_timing", NULL, 0))
+            av_dict_set(&ost->encoder_opts, "stage_timing", "1", 0);
         if (ost->enc->type == AVMEDIA_TYPE_AUDIO &&
             !codec->defaults &&
             !av_dict_get(ost->encoder_opts, "b", NULL, 0) &&
@@ -3472,6 +3502,16 @@ static int transcode_init(void)
         }
     }
 
+    /* take the streams transcoded in chunks out of the main loop */
+    for (i = 0; i < nb_output_streams; i++) {
+        ost = output_streams[i];
+        if (ost->chunk_threads > 1 && (ret = chunk_transcode_init(ost)) < 0) {
+            snprintf(error, sizeof(error), "Error splitting output stream #%d:%d in chunks",
+                     ost->file_index, ost->index);
+            goto dump_format;
+        }
+    }
+
     /* init input streams */
     for (i = 0; i < nb_input_streams; i++)
         if ((ret = init_input_stream(i, error, sizeof(error))) < 0) {
@@ -4304,6 +4344,31 @@ static int transcode_from_filter(FilterGraph *graph, InputStream **best_ist)
     return 0;
 }
 
+/*
+ * Mux the next packet of a stream transcoded in chunks.
+ */
+static int transcode_chunk_packet(OutputStream *ost)
+{
+    OutputFile *of = output_files[ost->file_index];
+    AVPacket pkt;
+    int ret;
+
+    av_init_packet(&pkt);
+    ret = chunk_transcode_get_packet(ost, &pkt);
+    if (ret == AVERROR_EOF) {
+        close_output_stream(ost);
+        return 0;
+    }
+    if (ret < 0)
+        return ret;
+
+    ost->frames_encoded++;
+    ost->frame_number++;
+    av_packet_rescale_ts(&pkt, ost->enc_ctx->time_base, ost->st->time_base);
+    output_packet(of, &pkt, ost);
+    return 0;
+}
+
 /**
  * Run a single step of transcoding.
  *
@@ -4326,6 +4391,9 @@ static int transcode_step(void)
         return AVERROR_EOF;
     }
 
+    if (ost->chunk_ctx)
+        return transcode_chunk_packet(ost);
+
     if (ost->filter) {
         if ((ret = transcode_from_filter(ost->filter->graph, &ist)) < 0)
             return ret;
@@ -4437,6 +4505,19 @@ static int transcode(void)
     /* dump report by using the first video and audio streams */
     print_report(1, timer_start, av_gettime_relative());
 
+    if (do_benchmark_all) {
+        for (i = 0; i < nb_input_streams; i++) {
+            ist = input_streams[i];
+            if (ist->decoding_needed)
+                print_stage_timing(ist->dec_ctx, "decode", ist->file_index, ist->st->index);
+        }
+        for (i = 0; i < nb_output_streams; i++) {
+            ost = output_streams[i];
+            if (ost->encoding_needed)
+                print_stage_timing(ost->enc_ctx, "encode", ost->file_index, ost->index);
+        }
+    }
+
     /* close each encoder */
     for (i = 0; i < nb_output_streams; i++) {
         ost = output_streams[i];
@@ -214,6 +214,8 @@ typedef struct OptionsContext {
     int        nb_passlogfiles;
     SpecifierOpt *max_muxing_queue_size;
     int        nb_max_muxing_queue_size;
+    SpecifierOpt *chunk_threads;
+    int        nb_chunk_threads;
     SpecifierOpt *guess_layout_max;
     int        nb_guess_layout_max;
     SpecifierOpt *apad;
@@ -438,6 +440,7 @@ typedef struct OutputStream {
 
     /* video only */
     AVRational frame_rate;
+    int frame_rate_set; /* by -r, before transcode_init() fills it in */
     int is_cfr;
     int force_fps;
     int top_field_first;
@@ -511,6 +514,10 @@ typedef struct OutputStream {
 
     /* frame encode sum of squared error values */
     int64_t error[4];
+
+    /* transcoding in chunks by several threads */
+    int chunk_threads;
+    struct ChunkContext *chunk_ctx;
 } OutputStream;
 
 typedef struct OutputFile {
@@ -602,6 +609,10 @@ int init_complex_filtergraph(FilterGraph *fg);
 
 int ffmpeg_parse_options(int argc, char **argv);
 
+int chunk_transcode_init(OutputStream *ost);
+int chunk_transcode_get_packet(OutputStream *ost, AVPacket *pkt);
+void chunk_transcode_uninit(OutputStream *ost);
+
 int vdpau_init(AVCodecContext *s);
 int dxva2_init(AVCodecContext *s);
 int vda_init(AVCodecContext *s);
@@ -0,0 +1,841 @@
+/*
+ * ffmpeg transcoding of a stream in chunks, in parallel
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * The input video stream is split at keyframes into chunks, each decoded,
+ * filtered and encoded from its own demuxer by a separate set of contexts.
+ * A chunk ends where the next one starts: it is decoded up to the keyframe
+ * starting the next chunk and the pictures leading it, so that open GOPs
+ * are split without loss, and its frames are those with a timestamp in
+ * its range. Each encoder starts with a keyframe, the packets are muxed
+ * chunk after chunk with the timestamps of the input.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ffmpeg.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+#include "libavutil/avstring.h"
+#include "libavutil/bprint.h"
+#include "libavutil/fifo.h"
+#include "libavutil/internal.h"
+#include "libavutil/pixdesc.h"
+
+#if HAVE_PTHREADS
+
+/* chunks per thread, for balancing GOPs of different complexity */
+#define CHUNKS_PER_THREAD 4
+/* longest chunk wanted, in seconds, bounding the packets buffered */
+#define CHUNK_DURATION    10
+
+typedef struct Chunk {
+    /* location of the keyframe starting the chunk */
+    int64_t seek_ts;
+    int64_t seek_pos;
+    /* pts of that keyframe, AV_NOPTS_VALUE for the first chunk */
+    int64_t pts;
+
+    AVFifoBuffer *packets;      /* encoded packets waiting to be muxed */
+    int finished;
+    int ret;
+} Chunk;
+
+typedef struct ChunkContext {
+    OutputStream *ost;
+    InputStream  *ist;
+
+    Chunk *chunks;
+    int nb_chunks;
+    int seek_byte;              /* the chunks are located by their position */
+
+    AVCodecContext *enc_tmpl;   /* the encoder settings, unopened */
+    AVDictionary *enc_opts;
+    AVDictionary *dec_opts;
+    char *buffer_args;
+    char *graph_desc;
+
+    pthread_t *threads;
+    int nb_threads;
+    int threads_started;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int next_chunk;             /* next chunk to transcode */
+    int out_chunk;              /* chunk whose packets are muxed */
+    int64_t last_dts;           /* of the last packet muxed */
+    int abort;
+
+    uint64_t nb_packets;
+    uint64_t data_size;
+    uint64_t frames_decoded;
+} ChunkContext;
+
+/* the contexts transcoding one chunk */
+typedef struct ChunkJob {
+    Chunk *chunk;
+    int64_t start, end;         /* range of the frames kept, in the stream time base */
+    int64_t ts_offset;
+
+    AVFormatContext *ic;
+    AVCodecContext  *dec;
+    AVCodecContext  *enc;
+    AVFilterGraph   *graph;
+    AVFilterContext *src;
+    AVFilterContext *sink;
+    AVFrame *frame;
+    AVFrame *filtered_frame;
+    int64_t last_pts;
+
+    uint64_t nb_packets;
+    uint64_t data_size;
+    uint64_t frames_decoded;
+} ChunkJob;
+
+static const char *check_constraints(OutputStream *ost)
+{
+    InputStream *ist = ost->source_index >= 0 ? input_streams[ost->source_index] : NULL;
+    OutputFile   *of = output_files[ost->file_index];
+    InputFile     *f;
+    int i;
+
+    if (!ist || !ost->encoding_needed || ost->enc_ctx->codec_type != AVMEDIA_TYPE_VIDEO ||
+        !ost->filter || !filtergraph_is_simple(ost->filter->graph) || ist->nb_filters != 1)
+        return "it is not a video stream transcoded from a single input stream";
+    f = input_files[ist->file_index];
+
+    /* the main loop stops reading the input stream */
+    for (i = 0; i < nb_output_streams; i++)
+        if (output_streams[i] != ost && output_streams[i]->source_index == ost->source_index)
+            return "its input stream is used by another output stream";
+
+    if (!f->ctx->pb || !f->ctx->pb->seekable || f->ctx->iformat->flags & AVFMT_NOFILE)
+        return "the input is not seekable";
+    if (f->start_time != AV_NOPTS_VALUE || f->recording_time != INT64_MAX ||
+        of->start_time != AV_NOPTS_VALUE || of->recording_time != INT64_MAX ||
+        ost->max_frames != INT64_MAX || f->loop || f->rate_emu)
+        return "the input or the output is limited, looped or read at native rate";
+    if (ist->hwaccel_id != HWACCEL_NONE || hw_device_ctx)
+        return "hardware acceleration is used";
+    if (ist->framerate.num || ist->ts_scale != 1.0 || do_deinterlace ||
+        (ist->autorotate && fabs(get_rotation(ist->st)) > 1.0))
+        return "the input frames are retimed, deinterlaced or rotated";
+    if (ost->forced_keyframes || ost->logfile || vstats_filename ||
+        ost->enc_ctx->flags & (AV_CODEC_FLAG_PASS1 | AV_CODEC_FLAG_PASS2))
+        return "keyframes are forced, or two-pass encoding or video stats are enabled";
+    /* the frames of the chunks keep their timestamps, as with -vsync vfr */
+    if (ost->frame_rate_set || !(video_sync_method == VSYNC_PASSTHROUGH ||
+                                 video_sync_method == VSYNC_VFR ||
+                                 (video_sync_method == VSYNC_AUTO &&
+                                  (of->ctx->oformat->flags & AVFMT_VARIABLE_FPS ||
+                                   !strcmp(of->ctx->oformat->name, "avi")))))
+        return "frames would be duplicated or dropped to the output frame rate";
+    return NULL;
+}
+
+static int open_input(ChunkContext *c, AVFormatContext **pic)
+{
+    AVFormatContext *main_ic = input_files[c->ist->file_index]->ctx;
+    AVFormatContext *ic = avformat_alloc_context();
+    int idx = c->ist->st->index;
+    int i, ret;
+
+    if (!ic)
+        return AVERROR(ENOMEM);
+    ic->interrupt_callback = int_cb;
+
+    ret = avformat_open_input(&ic, main_ic->filename, main_ic->iformat, NULL);
+    if (ret < 0)
+        return ret;
+    if (idx >= ic->nb_streams ||
+        ic->streams[idx]->codecpar->codec_id != c->ist->st->codecpar->codec_id) {
+        av_log(NULL, AV_LOG_ERROR, "Stream #%d:%d not found when reopening %s\n",
+               c->ist->file_index, idx, ic->filename);
+        avformat_close_input(&ic);
+        return AVERROR(EINVAL);
+    }
+    for (i = 0; i < ic->nb_streams; i++)
+        ic->streams[i]->discard = i == idx ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+
+    *pic = ic;
+    return 0;
+}
+
+static int read_packet(ChunkContext *c, AVFormatContext *ic, AVPacket *pkt)
+{
+    int ret;
+
+    while ((ret = av_read_frame(ic, pkt)) >= 0) {
+        if (pkt->stream_index == c->ist->st->index)
+            return 0;
+        av_packet_unref(pkt);
+    }
+    return ret;
+}
+
+/* Seek to a chunk and read the first keyframe from it, not before pts. */
+static int seek_chunk(ChunkContext *c, AVFormatContext *ic, const Chunk *ch,
+                      int64_t pts, AVPacket *pkt)
+{
+    int ret;
+
+    if (c->seek_byte)
+        ret = av_seek_frame(ic, -1, ch->seek_pos, AVSEEK_FLAG_BYTE);
+    else
+        ret = av_seek_frame(ic, c->ist->st->index, ch->seek_ts, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0)
+        return ret;
+
+    while ((ret = read_packet(c, ic, pkt)) >= 0) {
+        if (pkt->flags & AV_PKT_FLAG_KEY && pkt->pts != AV_NOPTS_VALUE &&
+            (pts == AV_NOPTS_VALUE || pkt->pts >= pts))
+            return 0;
+        av_packet_unref(pkt);
+    }
+    return ret;
+}
+
+static int find_keyframes(ChunkContext *c, AVFormatContext *ic,
+                          Chunk **keyframes, int *nb_keyframes)
+{
+    AVStream *st = ic->streams[c->ist->st->index];
+    AVPacket pkt;
+    int i, ret;
+
+    /* the demuxers with an index in the container seek with it, some only
+     * load it on the first seek */
+    if (ic->iformat->read_seek) {
+        if (!st->nb_index_entries)
+            av_seek_frame(ic, st->index, st->start_time == AV_NOPTS_VALUE ? 0 : st->start_time,
+                          AVSEEK_FLAG_BACKWARD);
+        for (i = 0; i < st->nb_index_entries; i++) {
+            const AVIndexEntry *e = &st->index_entries[i];
+
+            if (!(e->flags & AVINDEX_KEYFRAME))
+                continue;
+            GROW_ARRAY(*keyframes, *nb_keyframes);
+            (*keyframes)[*nb_keyframes - 1].seek_ts = e->timestamp;
+        }
+        return 0;
+    }
+
+    /* otherwise read the positions of the keyframes and seek to them */
+    if (ic->iformat->flags & AVFMT_NO_BYTE_SEEK)
+        return 0;
+    c->seek_byte = 1;
+    while ((ret = read_packet(c, ic, &pkt)) >= 0) {
+        if (pkt.flags & AV_PKT_FLAG_KEY && pkt.pos >= 0 && pkt.pts != AV_NOPTS_VALUE) {
+            GROW_ARRAY(*keyframes, *nb_keyframes);
+            (*keyframes)[*nb_keyframes - 1].seek_pos = pkt.pos;
+        }
+        av_packet_unref(&pkt);
+    }
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+/* Split the input in chunks starting at some of its keyframes. */
+static int find_chunks(ChunkContext *c)
+{
+    AVFormatContext *ic = NULL;
+    Chunk *keyframes = NULL;
+    int nb_keyframes = 0, nb_chunks, i, ret;
+    int64_t last_pts = AV_NOPTS_VALUE;
+
+    if ((ret = open_input(c, &ic)) < 0)
+        return ret;
+    if ((ret = find_keyframes(c, ic, &keyframes, &nb_keyframes)) < 0)
+        goto end;
+
+    nb_chunks = c->nb_threads * CHUNKS_PER_THREAD;
+    if (ic->duration > 0)
+        nb_chunks = FFMAX(nb_chunks, ic->duration / (CHUNK_DURATION * AV_TIME_BASE));
+    nb_chunks = FFMIN(nb_chunks, nb_keyframes);
+
+    /* the first chunk starts with the input, the other ones at the
+     * keyframes spread evenly, where they really are */
+    GROW_ARRAY(c->chunks, c->nb_chunks);
+    c->chunks[0].pts = AV_NOPTS_VALUE;
+    for (i = 1; i < nb_chunks; i++) {
+        Chunk *ch = &keyframes[(int64_t)i * nb_keyframes / nb_chunks];
+        AVPacket pkt;
+
+        if (seek_chunk(c, ic, ch, AV_NOPTS_VALUE, &pkt) < 0)
+            continue;
+        ch->pts = pkt.pts;
+        av_packet_unref(&pkt);
+        if (last_pts != AV_NOPTS_VALUE && ch->pts <= last_pts)
+            continue;
+        last_pts = ch->pts;
+
+        GROW_ARRAY(c->chunks, c->nb_chunks);
+        c->chunks[c->nb_chunks - 1] = *ch;
+    }
+
+    for (i = 0; i < c->nb_chunks; i++)
+        if (!(c->chunks[i].packets = av_fifo_alloc(16 * sizeof(AVPacket)))) {
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+
+end:
+    av_freep(&keyframes);
+    avformat_close_input(&ic);
+    return ret;
+}
+
+static int init_filters(ChunkContext *c, ChunkJob *job)
+{
+    AVFilterInOut *outputs = avfilter_inout_alloc();
+    AVFilterInOut *inputs  = avfilter_inout_alloc();
+    AVDictionaryEntry *e = NULL;
+    char args[512];
+    int ret;
+
+    job->graph = avfilter_graph_alloc();
+    if (!job->graph || !outputs || !inputs) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    job->graph->nb_threads = 1;
+
+    args[0] = 0;
+    while ((e = av_dict_get(c->ost->sws_dict, "", e, AV_DICT_IGNORE_SUFFIX)))
+        av_strlcatf(args, sizeof(args), "%s=%s:", e->key, e->value);
+    if (strlen(args))
+        args[strlen(args) - 1] = 0;
+    job->graph->scale_sws_opts = av_strdup(args);
+
+    if ((ret = avfilter_graph_create_filter(&job->src, avfilter_get_by_name("buffer"), "in",
+                                            c->buffer_args, NULL, job->graph)) < 0 ||
+        (ret = avfilter_graph_create_filter(&job->sink, avfilter_get_by_name("buffersink"), "out",
+                                            NULL, NULL, job->graph)) < 0)
+        goto end;
+
+    outputs->name       = av_strdup("in");
+    outputs->filter_ctx = job->src;
+    inputs->name        = av_strdup("out");
+    inputs->filter_ctx  = job->sink;
+    if (!outputs->name || !inputs->name) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = avfilter_graph_parse_ptr(job->graph, c->graph_desc, &inputs, &outputs, NULL)) < 0)
+        goto end;
+    ret = avfilter_graph_config(job->graph, NULL);
+
+end:
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    return ret;
+}
+
+static int init_job(ChunkContext *c, ChunkJob *job, int idx)
+{
+    InputStream  *ist = c->ist;
+    OutputStream *ost = c->ost;
+    AVDictionary *opts = NULL;
+    int ret;
+
+    job->chunk     = &c->chunks[idx];
+    job->start     = c->chunks[idx].pts;
+    job->end       = idx + 1 < c->nb_chunks ? c->chunks[idx + 1].pts : AV_NOPTS_VALUE;
+    job->ts_offset = av_rescale_q(input_files[ist->file_index]->ts_offset,
+                                  AV_TIME_BASE_Q, ist->st->time_base);
+    job->last_pts  = AV_NOPTS_VALUE;
+
+    job->frame          = av_frame_alloc();
+    job->filtered_frame = av_frame_alloc();
+    job->dec            = avcodec_alloc_context3(ist->dec);
+    job->enc            = avcodec_alloc_context3(NULL);
+    if (!job->frame || !job->filtered_frame || !job->dec || !job->enc)
+        return AVERROR(ENOMEM);
+
+    if ((ret = open_input(c, &job->ic)) < 0)
+        return ret;
+
+    if ((ret = avcodec_parameters_to_context(job->dec, ist->st->codecpar)) < 0)
+        return ret;
+    job->dec->pkt_timebase = ist->st->time_base;
+    av_dict_copy(&opts, c->dec_opts, 0);
+    ret = avcodec_open2(job->dec, ist->dec, &opts);
+    av_dict_free(&opts);
+    if (ret < 0)
+        return ret;
+
+    if ((ret = init_filters(c, job)) < 0)
+        return ret;
+
+FF_DISABLE_DEPRECATION_WARNINGS
+    ret = avcodec_copy_context(job->enc, c->enc_tmpl);
+FF_ENABLE_DEPRECATION_WARNINGS
+    if (ret < 0)
+        return ret;
+    av_dict_copy(&opts, c->enc_opts, 0);
+    ret = avcodec_open2(job->enc, ost->enc, &opts);
+    av_dict_free(&opts);
+    if (ret < 0)
+        return ret;
+
+    /* the muxer got the global headers of the main encoder */
+    if (job->enc->extradata_size != ost->enc_ctx->extradata_size ||
+        (job->enc->extradata_size &&
+         memcmp(job->enc->extradata, ost->enc_ctx->extradata, job->enc->extradata_size))) {
+        av_log(NULL, AV_LOG_ERROR, "The encoder of a chunk of stream #%d:%d "
+               "has different global headers\n", ost->file_index, ost->index);
+        return AVERROR(EINVAL);
+    }
+    return 0;
+}
+
+static void free_job(ChunkJob *job)
+{
+    avformat_close_input(&job->ic);
+    avcodec_free_context(&job->dec);
+    avcodec_free_context(&job->enc);
+    avfilter_graph_free(&job->graph);
+    av_frame_free(&job->frame);
+    av_frame_free(&job->filtered_frame);
+}
+
+static int queue_packet(ChunkContext *c, Chunk *ch, AVPacket *pkt)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&c->lock);
+    if (c->abort)
+        ret = AVERROR_EXIT;
+    else if (!av_fifo_space(ch->packets))
+        ret = av_fifo_realloc2(ch->packets, 2 * av_fifo_size(ch->packets));
+    if (ret >= 0) {
+        av_fifo_generic_write(ch->packets, pkt, sizeof(*pkt), NULL);
+        pthread_cond_broadcast(&c->cond);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return ret;
+}
+
+static int encode_frame(ChunkContext *c, ChunkJob *job, const AVFrame *frame)
+{
+    AVPacket pkt;
+    int ret;
+
+    if ((ret = avcodec_send_frame(job->enc, frame)) < 0)
+        return ret;
+
+    for (;;) {
+        av_init_packet(&pkt);
+        pkt.data = NULL;
+        pkt.size = 0;
+
+        ret = avcodec_receive_packet(job->enc, &pkt);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            return 0;
+        if (ret < 0)
+            return ret;
+        if ((ret = queue_packet(c, job->chunk, &pkt)) < 0) {
+            av_packet_unref(&pkt);
+            return ret;
+        }
+    }
+}
+
+static int filter_frame(ChunkContext *c, ChunkJob *job, AVFrame *frame)
+{
+    AVFrame *filtered_frame = job->filtered_frame;
+    AVRational tb = job->sink->inputs[0]->time_base;
+    int ret;
+
+    if ((ret = av_buffersrc_add_frame_flags(job->src, frame, AV_BUFFERSRC_FLAG_PUSH)) < 0)
+        return ret;
+
+    while ((ret = av_buffersink_get_frame(job->sink, filtered_frame)) >= 0) {
+        if (filtered_frame->pts != AV_NOPTS_VALUE)
+            filtered_frame->pts = av_rescale_q(filtered_frame->pts, tb, job->enc->time_base);
+
+        /* frames falling on the same output timestamp are dropped */
+        if (filtered_frame->pts == AV_NOPTS_VALUE ||
+            (job->last_pts != AV_NOPTS_VALUE && filtered_frame->pts <= job->last_pts)) {
+            av_frame_unref(filtered_frame);
+            continue;
+        }
+        job->last_pts = filtered_frame->pts;
+
+        filtered_frame->pict_type = AV_PICTURE_TYPE_NONE;
+        filtered_frame->quality   = job->enc->global_quality;
+        ret = encode_frame(c, job, filtered_frame);
+        av_frame_unref(filtered_frame);
+        if (ret < 0)
+            return ret;
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int decode_packet(ChunkContext *c, ChunkJob *job, const AVPacket *pkt)
+{
+    AVFrame *frame = job->frame;
+    AVStream *st = c->ist->st;
+    int ret;
+
+    ret = avcodec_send_packet(job->dec, pkt);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        av_log(NULL, exit_on_error ? AV_LOG_FATAL : AV_LOG_WARNING,
+               "Error while decoding stream #%d:%d: %s\n",
+               c->ist->file_index, st->index, av_err2str(ret));
+        if (exit_on_error)
+            return ret;
+    }
+
+    while ((ret = avcodec_receive_frame(job->dec, frame)) >= 0) {
+        int64_t ts = av_frame_get_best_effort_timestamp(frame);
+
+        job->frames_decoded++;
+        if (ts == AV_NOPTS_VALUE ||
+            (job->start != AV_NOPTS_VALUE && ts <  job->start) ||
+            (job->end   != AV_NOPTS_VALUE && ts >= job->end)) {
+            av_frame_unref(frame);
+            continue;
+        }
+
+        frame->pts = ts + job->ts_offset;
+        if (st->sample_aspect_ratio.num)
+            frame->sample_aspect_ratio = st->sample_aspect_ratio;
+        ret = filter_frame(c, job, frame);
+        av_frame_unref(frame);
+        if (ret < 0)
+            return ret;
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int transcode_chunk(ChunkContext *c, int idx)
+{
+    ChunkJob job = { 0 };
+    AVPacket pkt;
+    int end_seen = 0, ret;
+
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    if ((ret = init_job(c, &job, idx)) < 0)
+        goto end;
+
+    if (job.start != AV_NOPTS_VALUE) {
+        ret = seek_chunk(c, job.ic, job.chunk, job.start, &pkt);
+        if (ret >= 0 && pkt.pts != job.start) {
+            av_log(NULL, AV_LOG_ERROR, "Keyframe at %"PRId64" starting chunk %d "
+                   "of stream #%d:%d not found\n", job.start, idx,
+                   c->ist->file_index, c->ist->st->index);
+            ret = AVERROR(EINVAL);
+        }
+    } else {
+        ret = read_packet(c, job.ic, &pkt);
+    }
+
+    while (ret >= 0) {
+        /* stop after the keyframe starting the next chunk and the pictures
+         * leading it */
+        if (job.end != AV_NOPTS_VALUE) {
+            if (end_seen && (pkt.pts == AV_NOPTS_VALUE || pkt.pts > job.end))
+                break;
+            if (pkt.flags & AV_PKT_FLAG_KEY && pkt.pts == job.end)
+                end_seen = 1;
+        }
+
+        job.nb_packets++;
+        job.data_size += pkt.size;
+        ret = decode_packet(c, &job, &pkt);
+        av_packet_unref(&pkt);
+        if (ret < 0)
+            goto end;
+        ret = read_packet(c, job.ic, &pkt);
+    }
+    av_packet_unref(&pkt);
+
+    if (ret == AVERROR_EOF && (job.end == AV_NOPTS_VALUE || end_seen))
+        ret = 0;
+    if (ret >= 0)
+        ret = decode_packet(c, &job, NULL);
+    if (ret >= 0)
+        ret = filter_frame(c, &job, NULL);
+    if (ret >= 0)
+        ret = encode_frame(c, &job, NULL);
+
+end:
+    if (ret < 0 && ret != AVERROR_EXIT)
+        av_log(NULL, AV_LOG_ERROR, "Error transcoding chunk %d of stream #%d:%d: %s\n",
+               idx, c->ost->file_index, c->ost->index, av_err2str(ret));
+
+    pthread_mutex_lock(&c->lock);
+    c->nb_packets     += job.nb_packets;
+    c->data_size      += job.data_size;
+    c->frames_decoded += job.frames_decoded;
+    pthread_mutex_unlock(&c->lock);
+
+    free_job(&job);
+    return ret;
+}
+
+static void *chunk_thread(void *arg)
+{
+    ChunkContext *c = arg;
+
+    pthread_mutex_lock(&c->lock);
+    while (!c->abort && c->next_chunk < c->nb_chunks) {
+        int idx = c->next_chunk, ret;
+
+        /* do not get too far ahead of the muxing */
+        if (idx >= c->out_chunk + 2 * c->nb_threads) {
+            pthread_cond_wait(&c->cond, &c->lock);
+            continue;
+        }
+        c->next_chunk++;
+        pthread_mutex_unlock(&c->lock);
+
+        ret = transcode_chunk(c, idx);
+
+        pthread_mutex_lock(&c->lock);
+        c->chunks[idx].ret      = ret;
+        c->chunks[idx].finished = 1;
+        pthread_cond_broadcast(&c->cond);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return NULL;
+}
+
+static int start_threads(ChunkContext *c)
+{
+    int i, ret;
+
+    c->threads = av_mallocz_array(c->nb_threads, sizeof(*c->threads));
+    if (!c->threads)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < c->nb_threads; i++) {
+        if ((ret = pthread_create(&c->threads[i], NULL, chunk_thread, c))) {
+            av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s\n", strerror(ret));
+            return AVERROR(ret);
+        }
+        c->threads_started++;
+    }
+    return 0;
+}
+
+int chunk_transcode_init(OutputStream *ost)
+{
+    const char *reason = check_constraints(ost);
+    InputStream *ist;
+    ChunkContext *c;
+    AVRational sar;
+    AVBPrint args;
+    int ret;
+
+    if (reason) {
+        av_log(NULL, AV_LOG_WARNING, "Cannot transcode stream #%d:%d in chunks: %s.\n",
+               ost->file_index, ost->index, reason);
+        return 0;
+    }
+    ist = input_streams[ost->source_index];
+
+    c = av_mallocz(sizeof(*c));
+    if (!c)
+        return AVERROR(ENOMEM);
+    c->ost        = ost;
+    c->ist        = ist;
+    c->nb_threads = ost->chunk_threads;
+    c->last_dts   = AV_NOPTS_VALUE;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->cond, NULL);
+    ost->chunk_ctx = c;
+
+    if ((ret = find_chunks(c)) < 0)
+        return ret;
+    if (c->nb_chunks < 2) {
+        av_log(NULL, AV_LOG_WARNING, "Cannot transcode stream #%d:%d in chunks: "
+               "no keyframes to split the input at.\n", ost->file_index, ost->index);
+        chunk_transcode_uninit(ost);
+        return 0;
+    }
+
+    /* the settings the encoder and decoder of each chunk are opened with,
+     * the threading of which is the chunks by default */
+    c->enc_tmpl = avcodec_alloc_context3(NULL);
+    if (!c->enc_tmpl)
+        return AVERROR(ENOMEM);
+FF_DISABLE_DEPRECATION_WARNINGS
+    ret = avcodec_copy_context(c->enc_tmpl, ost->enc_ctx);
+FF_ENABLE_DEPRECATION_WARNINGS
+    if (ret < 0)
+        return ret;
+    av_dict_copy(&c->enc_opts, ost->encoder_opts, 0);
+    av_dict_set(&c->enc_opts, "threads", "1", AV_DICT_DONT_OVERWRITE);
+    av_dict_copy(&c->dec_opts, ist->decoder_opts, 0);
+    av_dict_set(&c->dec_opts, "threads", "1", AV_DICT_DONT_OVERWRITE);
+
+    /* the filters of the stream, ending with the frames the encoder takes */
+    sar = ist->st->sample_aspect_ratio.num ? ist->st->sample_aspect_ratio :
+                                            ist->dec_ctx->sample_aspect_ratio;
+    if (!sar.den)
+        sar = (AVRational){ 0, 1 };
+    av_bprint_init(&args, 0, AV_BPRINT_SIZE_UNLIMITED);
+    av_bprintf(&args, "video_size=%dx%d:pix_fmt=%d:time_base=%d/%d:"
+               "pixel_aspect=%d/%d:sws_param=flags=%d",
+               ist->resample_width, ist->resample_height, ist->resample_pix_fmt,
+               ist->st->time_base.num, ist->st->time_base.den, sar.num, sar.den,
+               SWS_BILINEAR + ((ist->dec_ctx->flags & AV_CODEC_FLAG_BITEXACT) ? SWS_BITEXACT : 0));
+    av_bprint_finalize(&args, &c->buffer_args);
+    c->graph_desc = av_asprintf("%s,scale=%d:%d,format=%s", ost->avfilter,
+                                ost->enc_ctx->width, ost->enc_ctx->height,
+                                av_get_pix_fmt_name(ost->enc_ctx->pix_fmt));
+    if (!c->buffer_args || !c->graph_desc)
+        return AVERROR(ENOMEM);
+
+    /* the input stream is not decoded by the main loop anymore */
+    ist->decoding_needed = 0;
+    ist->discard         = 1;
+    ist->st->discard     = AVDISCARD_ALL;
+
+    av_log(NULL, AV_LOG_INFO, "Transcoding stream #%d:%d in %d chunks with %d threads\n",
+           ost->file_index, ost->index, c->nb_chunks, c->nb_threads);
+    return 0;
+}
+
+/* Every encoder starts with its DTS below its PTS by its reordering delay,
+ * so the first packets of a chunk may not decode after the last ones of the
+ * previous chunk. Their DTS are moved forward just enough, which leaves them
+ * below their PTS when the encoders have the same delay, as the timestamps
+ * of the chunks do not overlap. */
+static int fix_dts(ChunkContext *c, AVPacket *pkt)
+{
+    if (pkt->dts == AV_NOPTS_VALUE)
+        return 0;
+
+    if (c->last_dts != AV_NOPTS_VALUE && pkt->dts <= c->last_dts)
+        pkt->dts = c->last_dts + 1;
+    if (pkt->pts != AV_NOPTS_VALUE && pkt->dts > pkt->pts) {
+        av_log(NULL, AV_LOG_ERROR, "Cannot join chunk %d of stream #%d:%d to "
+               "the previous one: DTS %"PRId64" is above PTS %"PRId64".\n",
+               c->out_chunk, c->ost->file_index, c->ost->index, pkt->dts, pkt->pts);
+        av_packet_unref(pkt);
+        return AVERROR(EINVAL);
+    }
+    c->last_dts = pkt->dts;
+    return 0;
+}
+
+int chunk_transcode_get_packet(OutputStream *ost, AVPacket *pkt)
+{
+    ChunkContext *c = ost->chunk_ctx;
+    int ret = AVERROR_EOF;
+
+    if (!c->threads && (ret = start_threads(c)) < 0)
+        return ret;
+
+    pthread_mutex_lock(&c->lock);
+    while (c->out_chunk < c->nb_chunks) {
+        Chunk *ch = &c->chunks[c->out_chunk];
+
+        if (av_fifo_size(ch->packets)) {
+            av_fifo_generic_read(ch->packets, pkt, sizeof(*pkt), NULL);
+            ret = fix_dts(c, pkt);
+            break;
+        }
+        if (ch->finished) {
+            if ((ret = ch->ret) < 0)
+                break;
+            c->out_chunk++;
+            pthread_cond_broadcast(&c->cond);
+            continue;
+        }
+        pthread_cond_wait(&c->cond, &c->lock);
+    }
+    if (c->out_chunk == c->nb_chunks) {
+        ret = AVERROR_EOF;
+        c->ist->nb_packets     = c->nb_packets;
+        c->ist->data_size      = c->data_size;
+        c->ist->frames_decoded = c->frames_decoded;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return ret;
+}
+
+void chunk_transcode_uninit(OutputStream *ost)
+{
+    ChunkContext *c = ost->chunk_ctx;
+    int i;
+
+    if (!c)
+        return;
+
+    pthread_mutex_lock(&c->lock);
+    c->abort = 1;
+    pthread_cond_broadcast(&c->cond);
+    pthread_mutex_unlock(&c->lock);
+    for (i = 0; i < c->threads_started; i++)
+        pthread_join(c->threads[i], NULL);
+    av_freep(&c->threads);
+
+    for (i = 0; i < c->nb_chunks; i++) {
+        Chunk *ch = &c->chunks[i];
+
+        while (ch->packets && av_fifo_size(ch->packets)) {
+            AVPacket pkt;
+            av_fifo_generic_read(ch->packets, &pkt, sizeof(pkt), NULL);
+            av_packet_unref(&pkt);
+        }
+        av_fifo_freep(&ch->packets);
+    }
+    av_freep(&c->chunks);
+
+    avcodec_free_context(&c->enc_tmpl);
+    av_dict_free(&c->enc_opts);
+    av_dict_free(&c->dec_opts);
+    av_freep(&c->buffer_args);
+    av_freep(&c->graph_desc);
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->cond);
+    av_freep(&ost->chunk_ctx);
+}
+
+#else
+
+int chunk_transcode_init(OutputStream *ost)
+{
+    av_log(NULL, AV_LOG_WARNING, "Cannot transcode stream #%d:%d in chunks: "
+           "threads are not supported.\n", ost->file_index, ost->index);
+    return 0;
+}
+
+int chunk_transcode_get_packet(OutputStream *ost, AVPacket *pkt)
+{
+    return AVERROR(ENOSYS);
+}
+
+void chunk_transcode_uninit(OutputStream *ost)
+{
+}
+
+#endif /* HAVE_PTHREADS */
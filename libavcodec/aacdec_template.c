@@ -1075,6 +1075,8 @@ static void aacdec_init(AACContext *ac);
 
 static av_cold void aac_static_table_init(void)
 {
+    int64_t start = av_gettime_relative();
+
     AAC_INIT_VLC_STATIC( 0, 304);
     AAC_INIT_VLC_STATIC( 1, 270);
     AAC_INIT_VLC_STATIC( 2, 550);
@@ -1109,6 +1111,8 @@ static av_cold void aac_static_table_init(void)
     AAC_RENAME(ff_init_ff_sine_windows)( 7);
 
     AAC_RENAME(ff_cbrt_tableinit)();
+
+    ff_table_init_report("AAC", start);
 }
 
 static AVOnce aac_table_init = AV_ONCE_INIT;
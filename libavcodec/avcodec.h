@@ -1670,6 +1670,30 @@ enum AVFieldOrder {
     AV_FIELD_BT,          //< Bottom coded first, top displayed first
 };
 
+/**
+ * Stages of the coding process whose duration can be recorded,
+ * see AVCodecContext.stage_timing.
+ */
+enum AVCodecStage {
+    AV_CODEC_STAGE_ENTROPY,     ///< entropy decoding of the syntax elements
+    AV_CODEC_STAGE_RECON,       ///< reconstruction: prediction, inverse transform
+    AV_CODEC_STAGE_LOOP_FILTER, ///< in-loop filtering
+    AV_CODEC_STAGE_ME,          ///< motion estimation
+    AV_CODEC_STAGE_RDO,         ///< rate-distortion optimized mode decision
+    AV_CODEC_STAGE_NB           ///< Not part of ABI
+};
+
+/**
+ * Activity of a frame decoding thread, see avcodec_get_thread_stats().
+ * Times are in microseconds, counted from the start of the thread.
+ */
+typedef struct AVCodecThreadStats {
+    int64_t busy_time;  ///< time spent decoding packets
+    int64_t idle_time;  ///< time spent waiting for a packet
+    int     nb_frames;  ///< number of packets decoded
+    int     active;     ///< 1 if the thread currently receives packets
+} AVCodecThreadStats;
+
 /**
  * main external API structure.
  * New fields can be added to the end with minor version bumps.
@@ -3574,6 +3598,35 @@ typedef struct AVCodecContext {
      */
     int trailing_padding;
 
+    /**
+     * Maximum number of frames of delay added by frame threading.
+     * When this or thread_max_delay_ms is set, the number of threads that
+     * are actually used is adapted to the observed decoding time, starting
+     * from two (one frame of delay) and growing only as far as needed to keep
+     * up with the frame rate, within the limit set here.
+     * 0 means no limit, all thread_count threads are used.
+     * - decoding: Set by user.
+     * - encoding: unused
+     */
+    int thread_max_delay;
+
+    /**
+     * Maximum delay added by frame threading, in milliseconds, converted to
+     * a number of frames using the frame rate of the stream.
+     * See thread_max_delay.
+     * - decoding: Set by user.
+     * - encoding: unused
+     */
+    int thread_max_delay_ms;
+
+    /**
+     * Record the time spent in each stage of the coding process, for
+     * the codecs which support it. The times can be retrieved with
+     * avcodec_get_stage_timing().
+     * - decoding: Set by user.
+     * - encoding: Set by user.
+     */
+    int stage_timing;
 } AVCodecContext;
 
 AVRational av_codec_get_pkt_timebase         (const AVCodecContext *avctx);
@@ -5629,6 +5682,49 @@ const char *av_get_profile_name(const AVCodec *codec, int profile);
  */
 const char *avcodec_profile_name(enum AVCodecID codec_id, int profile);
 
+/**
+ * Return the name of a stage of the coding process.
+ *
+ * @return a static string, or NULL if stage is invalid
+ */
+const char *avcodec_stage_name(enum AVCodecStage stage);
+
+/**
+ * Get the time spent in a stage of the coding process, as recorded when
+ * AVCodecContext.stage_timing is set.
+ *
+ * The time is in units of the CPU cycle counter where one is available
+ * (the same units as the START_TIMER/STOP_TIMER macros), in microseconds
+ * otherwise. With frame threading, frames are accounted once they are
+ * returned to the caller.
+ *
+ * @param avctx an opened codec context
+ * @param stage the stage to query
+ * @param[out] time the total time spent in the stage
+ * @param[out] count the number of times the stage was timed, 0 if the codec
+ *                   does not record this stage
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int avcodec_get_stage_timing(const AVCodecContext *avctx, enum AVCodecStage stage,
+                             uint64_t *time, uint64_t *count);
+
+/**
+ * Get the activity of the frame decoding threads.
+ *
+ * The figures are computed when this function is called, it must not be
+ * called concurrently with the decoding functions. This is the only way to
+ * read them: unlike an exported AVOption, it does not need every thread's
+ * progress to be locked and sampled after each decoded packet.
+ *
+ * @param avctx an opened codec context
+ * @param[out] stats array filled with the activity of the threads
+ * @param nb_stats number of elements of stats
+ * @return the number of frame threads, which may be larger than nb_stats,
+ *         0 if frame threading is not used
+ */
+int avcodec_get_thread_stats(AVCodecContext *avctx, AVCodecThreadStats *stats,
+                             int nb_stats);
+
 int avcodec_default_execute(AVCodecContext *c, int (*func)(AVCodecContext *c2, void *arg2),void *arg, int *ret, int count, int size);
 int avcodec_default_execute2(AVCodecContext *c, int (*func)(AVCodecContext *c2, void *arg2, int, int),void *arg, int *ret, int count);
 //FIXME func typedef
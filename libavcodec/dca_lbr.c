@@ -21,6 +21,7 @@
 #define BITSTREAM_READER_LE
 
 #include "libavutil/channel_layout.h"
+#include "libavutil/thread.h"
 
 #include "dcadec.h"
 #include "dcadata.h"
@@ -130,19 +131,13 @@ static float    lpc_tab[16];
 
 static av_cold void init_tables(void)
 {
-    static int initialized;
     int i;
 
-    if (initialized)
-        return;
-
     for (i = 0; i < 256; i++)
         cos_tab[i] = cos(M_PI * i / 128);
 
     for (i = 0; i < 16; i++)
         lpc_tab[i] = sin((i - 8) * (M_PI / ((i < 8) ? 17 : 15)));
-
-    initialized = 1;
 }
 
 static int parse_lfe_24(DCALbrDecoder *s)
@@ -1822,7 +1817,9 @@ av_cold void ff_dca_lbr_flush(DCALbrDecoder *s)
 
 av_cold int ff_dca_lbr_init(DCALbrDecoder *s)
 {
-    init_tables();
+    static AVOnce init_static_once = AV_ONCE_INIT;
+
+    ff_thread_once(&init_static_once, init_tables);
 
     if (!(s->fdsp = avpriv_float_dsp_alloc(0)))
         return AVERROR(ENOMEM);
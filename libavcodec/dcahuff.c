@@ -21,9 +21,11 @@
  */
 
 #include "libavutil/common.h"
+#include "libavutil/thread.h"
 
 #include "avcodec.h"
 #include "get_bits.h"
+#include "internal.h"
 #include "dcahuff.h"
 
 #define TMODE_COUNT 4
@@ -1261,15 +1263,12 @@ VLC     ff_dca_vlc_grid_2;
 VLC     ff_dca_vlc_grid_3;
 VLC     ff_dca_vlc_rsd;
 
-av_cold void ff_dca_init_vlcs(void)
+static av_cold void dca_init_vlcs(void)
 {
     static VLC_TYPE dca_table[30214][2];
-    static int vlcs_initialized = 0;
+    int64_t start = av_gettime_relative();
     int i, j, k = 0;
 
-    if (vlcs_initialized)
-        return;
-
 #define DCA_INIT_VLC(vlc, a, b, c, d)                                       \
     do {                                                                    \
         vlc.table           = &dca_table[vlc_offs[k]];                      \
@@ -1333,5 +1332,11 @@ av_cold void ff_dca_init_vlcs(void)
     LBR_INIT_VLC(ff_dca_vlc_grid_3,      grid_3,      9);
     LBR_INIT_VLC(ff_dca_vlc_rsd,         rsd,         6);
 
-    vlcs_initialized = 1;
+    ff_table_init_report("DCA VLC", start);
+}
+
+av_cold void ff_dca_init_vlcs(void)
+{
+    static AVOnce init_static_once = AV_ONCE_INIT;
+    ff_thread_once(&init_static_once, dca_init_vlcs);
 }
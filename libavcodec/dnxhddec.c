@@ -40,6 +40,8 @@ typedef struct RowContext {
     DECLARE_ALIGNED(16, int16_t, blocks)[12][64];
     int luma_scale[64];
     int chroma_scale[64];
+    int luma_bias[64];
+    int chroma_bias[64];
     GetBitContext gb;
     int last_dc[3];
     int last_qscale;
@@ -69,12 +71,14 @@ typedef struct DNXHDContext {
     int is_444;
     int mbaff;
     int act;
+    int level_bias;
     int (*decode_dct_block)(const struct DNXHDContext *ctx,
                             RowContext *row, int n);
 } DNXHDContext;
 
 #define DNXHD_VLC_BITS 9
 #define DNXHD_DC_VLC_BITS 7
+#define DNXHD_AC_EOB 0x7FFF ///< AC VLC symbol of the end of block code
 
 static int dnxhd_decode_dct_block_8(const DNXHDContext *ctx,
                                     RowContext *row, int n);
@@ -109,7 +113,8 @@ static int dnxhd_init_vlc(DNXHDContext *ctx, uint32_t cid, int bitdepth)
 {
     int ret;
     if (cid != ctx->cid) {
-        int index;
+        uint16_t ac_symbols[257];
+        int i, index;
 
         if ((index = ff_dnxhd_get_cid_table(cid)) < 0) {
             av_log(ctx->avctx, AV_LOG_ERROR, "unsupported cid %d\n", cid);
@@ -127,17 +132,26 @@ static int dnxhd_init_vlc(DNXHDContext *ctx, uint32_t cid, int bitdepth)
         ff_free_vlc(&ctx->dc_vlc);
         ff_free_vlc(&ctx->run_vlc);
 
-        if ((ret = init_vlc(&ctx->ac_vlc, DNXHD_VLC_BITS, 257,
+        /* The AC and run VLCs return the level and flags, and the run,
+         * instead of indexes into the CID tables. */
+        for (i = 0; i < 257; i++)
+            ac_symbols[i] = i == ctx->cid_table->eob_index ? DNXHD_AC_EOB :
+                            ctx->cid_table->ac_info[2 * i] << 2 |
+                            ctx->cid_table->ac_info[2 * i + 1];
+
+        if ((ret = ff_init_vlc_sparse(&ctx->ac_vlc, DNXHD_VLC_BITS, 257,
                  ctx->cid_table->ac_bits, 1, 1,
-                 ctx->cid_table->ac_codes, 2, 2, 0)) < 0)
+                 ctx->cid_table->ac_codes, 2, 2,
+                 ac_symbols, 2, 2, 0)) < 0)
             goto out;
         if ((ret = init_vlc(&ctx->dc_vlc, DNXHD_DC_VLC_BITS, bitdepth > 8 ? 14 : 12,
                  ctx->cid_table->dc_bits, 1, 1,
                  ctx->cid_table->dc_codes, 1, 1, 0)) < 0)
             goto out;
-        if ((ret = init_vlc(&ctx->run_vlc, DNXHD_VLC_BITS, 62,
+        if ((ret = ff_init_vlc_sparse(&ctx->run_vlc, DNXHD_VLC_BITS, 62,
                  ctx->cid_table->run_bits, 1, 1,
-                 ctx->cid_table->run_codes, 2, 2, 0)) < 0)
+                 ctx->cid_table->run_codes, 2, 2,
+                 ctx->cid_table->run, 1, 1, 0)) < 0)
             goto out;
 
         ctx->cid = cid;
@@ -246,21 +260,26 @@ static int dnxhd_decode_header(DNXHDContext *ctx, AVFrame *frame,
             return AVERROR_INVALIDDATA;
         } else if (bitdepth == 10) {
             ctx->decode_dct_block = dnxhd_decode_dct_block_10_444;
+            ctx->level_bias       = 32;
             ctx->pix_fmt = ctx->act ? AV_PIX_FMT_YUV444P10
                                     : AV_PIX_FMT_GBRP10;
         } else {
             ctx->decode_dct_block = dnxhd_decode_dct_block_12_444;
+            ctx->level_bias       = 32;
             ctx->pix_fmt = ctx->act ? AV_PIX_FMT_YUV444P12
                                     : AV_PIX_FMT_GBRP12;
         }
     } else if (bitdepth == 12) {
         ctx->decode_dct_block = dnxhd_decode_dct_block_12;
+        ctx->level_bias       = 8;
         ctx->pix_fmt = AV_PIX_FMT_YUV422P12;
     } else if (bitdepth == 10) {
         ctx->decode_dct_block = dnxhd_decode_dct_block_10;
+        ctx->level_bias       = 8;
         ctx->pix_fmt = AV_PIX_FMT_YUV422P10;
     } else {
         ctx->decode_dct_block = dnxhd_decode_dct_block_8;
+        ctx->level_bias       = 32;
         ctx->pix_fmt = AV_PIX_FMT_YUV422P;
     }
 
@@ -341,17 +360,13 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
                                                    RowContext *row,
                                                    int n,
                                                    int index_bits,
-                                                   int level_bias,
                                                    int level_shift,
                                                    int dc_shift)
 {
-    int i, j, index1, index2, len, flags;
+    int i, j, ac, run, len;
     int level, component, sign;
-    const int *scale;
-    const uint8_t *weight_matrix;
-    const uint8_t *ac_info = ctx->cid_table->ac_info;
+    const int *scale, *bias;
     int16_t *block = row->blocks[n];
-    const int eob_index     = ctx->cid_table->eob_index;
     int ret = 0;
     OPEN_READER(bs, &row->gb);
 
@@ -359,22 +374,22 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
 
     if (!ctx->is_444) {
         if (n & 2) {
-            component     = 1 + (n & 1);
-            scale = row->chroma_scale;
-            weight_matrix = ctx->cid_table->chroma_weight;
+            component = 1 + (n & 1);
+            scale     = row->chroma_scale;
+            bias      = row->chroma_bias;
         } else {
-            component     = 0;
-            scale = row->luma_scale;
-            weight_matrix = ctx->cid_table->luma_weight;
+            component = 0;
+            scale     = row->luma_scale;
+            bias      = row->luma_bias;
         }
     } else {
         component = (n >> 1) % 3;
         if (component) {
             scale = row->chroma_scale;
-            weight_matrix = ctx->cid_table->chroma_weight;
+            bias  = row->chroma_bias;
         } else {
             scale = row->luma_scale;
-            weight_matrix = ctx->cid_table->luma_weight;
+            bias  = row->luma_bias;
         }
     }
 
@@ -396,26 +411,31 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
     i = 0;
 
     UPDATE_CACHE(bs, &row->gb);
-    GET_VLC(index1, bs, &row->gb, ctx->ac_vlc.table,
+    GET_VLC(ac, bs, &row->gb, ctx->ac_vlc.table,
             DNXHD_VLC_BITS, 2);
 
-    while (index1 != eob_index) {
-        level = ac_info[2*index1+0];
-        flags = ac_info[2*index1+1];
+    while (ac != DNXHD_AC_EOB) {
+        if (ac < 0) {
+            av_log(ctx->avctx, AV_LOG_ERROR, "invalid ac code 0x%03x at bit %u\n",
+                   SHOW_UBITS(bs, &row->gb, DNXHD_VLC_BITS), bs_index);
+            ret = -1;
+            break;
+        }
+        level = ac >> 2;
 
         sign = SHOW_SBITS(bs, &row->gb, 1);
         SKIP_BITS(bs, &row->gb, 1);
 
-        if (flags & 1) {
+        if (ac & 1) {
             level += SHOW_UBITS(bs, &row->gb, index_bits) << 7;
             SKIP_BITS(bs, &row->gb, index_bits);
         }
 
-        if (flags & 2) {
+        if (ac & 2) {
             UPDATE_CACHE(bs, &row->gb);
-            GET_VLC(index2, bs, &row->gb, ctx->run_vlc.table,
+            GET_VLC(run, bs, &row->gb, ctx->run_vlc.table,
                     DNXHD_VLC_BITS, 2);
-            i += ctx->cid_table->run[index2];
+            i += run;
         }
 
         if (++i > 63) {
@@ -425,16 +445,12 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
         }
 
         j     = ctx->scantable.permutated[i];
-        level *= scale[i];
-        level += scale[i] >> 1;
-        if (level_bias < 32 || weight_matrix[i] != level_bias)
-            level += level_bias; // 1<<(level_shift-1)
-        level >>= level_shift;
+        level = (level * scale[i] + bias[i]) >> level_shift;
 
         block[j] = (level ^ sign) - sign;
 
         UPDATE_CACHE(bs, &row->gb);
-        GET_VLC(index1, bs, &row->gb, ctx->ac_vlc.table,
+        GET_VLC(ac, bs, &row->gb, ctx->ac_vlc.table,
                 DNXHD_VLC_BITS, 2);
     }
 error:
@@ -445,31 +461,31 @@ error:
 static int dnxhd_decode_dct_block_8(const DNXHDContext *ctx,
                                     RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 4, 32, 6, 0);
+    return dnxhd_decode_dct_block(ctx, row, n, 4, 6, 0);
 }
 
 static int dnxhd_decode_dct_block_10(const DNXHDContext *ctx,
                                      RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 8, 4, 0);
+    return dnxhd_decode_dct_block(ctx, row, n, 6, 4, 0);
 }
 
 static int dnxhd_decode_dct_block_10_444(const DNXHDContext *ctx,
                                          RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 32, 6, 0);
+    return dnxhd_decode_dct_block(ctx, row, n, 6, 6, 0);
 }
 
 static int dnxhd_decode_dct_block_12(const DNXHDContext *ctx,
                                      RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 8, 4, 2);
+    return dnxhd_decode_dct_block(ctx, row, n, 6, 4, 2);
 }
 
 static int dnxhd_decode_dct_block_12_444(const DNXHDContext *ctx,
                                          RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 32, 4, 2);
+    return dnxhd_decode_dct_block(ctx, row, n, 6, 4, 2);
 }
 
 static int dnxhd_decode_macroblock(const DNXHDContext *ctx, RowContext *row,
@@ -506,9 +522,21 @@ static int dnxhd_decode_macroblock(const DNXHDContext *ctx, RowContext *row,
     }
 
     if (qscale != row->last_qscale) {
+        const uint8_t *luma_weight   = ctx->cid_table->luma_weight;
+        const uint8_t *chroma_weight = ctx->cid_table->chroma_weight;
+        int level_bias = ctx->level_bias;
+
+        /* The rounding of the dequantization: half the scale, plus
+         * level_bias unless the weight is equal to a level_bias of 32. */
         for (i = 0; i < 64; i++) {
-            row->luma_scale[i]   = qscale * ctx->cid_table->luma_weight[i];
-            row->chroma_scale[i] = qscale * ctx->cid_table->chroma_weight[i];
+            row->luma_scale[i]   = qscale * luma_weight[i];
+            row->chroma_scale[i] = qscale * chroma_weight[i];
+            row->luma_bias[i]    = (row->luma_scale[i] >> 1) +
+                                   (level_bias < 32 || luma_weight[i] != level_bias ?
+                                    level_bias : 0);
+            row->chroma_bias[i]  = (row->chroma_scale[i] >> 1) +
+                                   (level_bias < 32 || chroma_weight[i] != level_bias ?
+                                    level_bias : 0);
         }
         row->last_qscale = qscale;
     }
@@ -612,8 +640,11 @@ static int dnxhd_decode_frame(AVCodecContext *avctx, void *data,
 
     ff_dlog(avctx, "frame size %d\n", buf_size);
 
-    for (i = 0; i < avctx->thread_count; i++)
-        ctx->rows[i].format = -1;
+    for (i = 0; i < avctx->thread_count; i++) {
+        ctx->rows[i].format      = -1;
+        // the scales depend on the CID, recompute them for each frame
+        ctx->rows[i].last_qscale = -1;
+    }
 
 decode_coding_unit:
     if ((ret = dnxhd_decode_header(ctx, picture, buf, buf_size, first_field)) < 0)
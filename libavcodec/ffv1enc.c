@@ -512,6 +512,20 @@ static int sort_stt(FFV1Context *s, uint8_t stt[256])
     return print;
 }
 
+/**
+ * Number of slices to use when the user did not set it: one per slice
+ * thread, as long as the slices are not smaller than 256x256 pixels.
+ * The minimum is the historical default of 4 slices.
+ */
+static av_cold int choose_slice_count(AVCodecContext *avctx)
+{
+    int threads = avctx->active_thread_type & FF_THREAD_SLICE ?
+                  avctx->thread_count : 1;
+    int64_t max_slices = (int64_t)avctx->width * avctx->height / (256 * 256);
+
+    return av_clip(FFMIN(threads, max_slices), 4, 64);
+}
+
 static av_cold int encode_init(AVCodecContext *avctx)
 {
     FFV1Context *s = avctx->priv_data;
@@ -527,8 +541,11 @@ static av_cold int encode_init(AVCodecContext *avctx)
         avctx->slices > 1)
         s->version = FFMAX(s->version, 2);
 
-    // Unspecified level & slices, we choose version 1.2+ to ensure multithreaded decodability
-    if (avctx->slices == 0 && avctx->level < 0 && avctx->width * avctx->height > 720*576)
+    // Unspecified level & slices, we choose version 1.2+ to ensure multithreaded decodability,
+    // and to encode one slice per slice thread
+    if (avctx->slices == 0 && avctx->level < 0 &&
+        (avctx->width * avctx->height > 720*576 ||
+         avctx->active_thread_type & FF_THREAD_SLICE && avctx->thread_count > 1))
         s->version = FFMAX(s->version, 2);
 
     if (avctx->level <= 0 && s->version == 2) {
@@ -852,10 +869,13 @@ FF_ENABLE_DEPRECATION_WARNINGS
     }
 
     if (s->version > 1) {
+        int auto_slices = choose_slice_count(avctx);
         s->num_v_slices = (avctx->width > 352 || avctx->height > 288 || !avctx->slices) ? 2 : 1;
         for (; s->num_v_slices < 9; s->num_v_slices++) {
             for (s->num_h_slices = s->num_v_slices; s->num_h_slices < 2*s->num_v_slices; s->num_h_slices++) {
-                if (avctx->slices == s->num_h_slices * s->num_v_slices && avctx->slices <= 64 || !avctx->slices)
+                if (avctx->slices == s->num_h_slices * s->num_v_slices && avctx->slices <= 64 ||
+                    !avctx->slices && s->num_h_slices * s->num_v_slices >= auto_slices &&
+                                      s->num_h_slices * s->num_v_slices <= 64)
                     goto slices_ok;
             }
         }
@@ -53,6 +53,23 @@
 #define UNCHECKED_BITSTREAM_READER !CONFIG_SAFE_BITSTREAM_READER
 #endif
 
+/*
+ * Cached bitstream reader:
+ * by default, UPDATE_CACHE() loads 32 bits (64 bits with
+ * LONG_BITSTREAM_READER) from the buffer every time it is called.
+ * A decoder can "#define CACHED_BITSTREAM_READER 1" to read through a
+ * 64-bit cache instead, which UPDATE_CACHE() only reloads when fewer than
+ * MIN_CACHE_BITS bits are left in it.
+ * The API, the GetBitContext and the semantics of the macros are the same
+ * with both readers. The cache only lives between OPEN_READER() and
+ * CLOSE_READER(), so both readers can be used on the same GetBitContext,
+ * and the gain comes from the loops which read many codes between them.
+ * libavcodec/tests/get_bits compares the speed of the two readers.
+ */
+#ifndef CACHED_BITSTREAM_READER
+#define CACHED_BITSTREAM_READER 0
+#endif
+
 typedef struct GetBitContext {
     const uint8_t *buffer, *buffer_end;
     int index;
@@ -107,15 +124,24 @@ typedef struct GetBitContext {
  * For examples see get_bits, show_bits, skip_bits, get_vlc.
  */
 
-#ifdef LONG_BITSTREAM_READER
+#if CACHED_BITSTREAM_READER || defined(LONG_BITSTREAM_READER)
 #   define MIN_CACHE_BITS 32
 #else
 #   define MIN_CACHE_BITS 25
 #endif
 
+#if CACHED_BITSTREAM_READER
+/* _cache holds the bits from _cache_pos to _cache_end */
+#define OPEN_READER_NOSIZE(name, gb)                        \
+    unsigned int name ## _index               = (gb)->index; \
+    unsigned int av_unused name ## _cache_pos = 0;          \
+    unsigned int av_unused name ## _cache_end = 0;          \
+    uint64_t     av_unused name ## _cache     = 0
+#else
 #define OPEN_READER_NOSIZE(name, gb)            \
     unsigned int name ## _index = (gb)->index;  \
     unsigned int av_unused name ## _cache
+#endif
 
 #if UNCHECKED_BITSTREAM_READER
 #define OPEN_READER(name, gb) OPEN_READER_NOSIZE(name, gb)
@@ -131,7 +157,37 @@ typedef struct GetBitContext {
 
 #define CLOSE_READER(name, gb) (gb)->index = name ## _index
 
-# ifdef LONG_BITSTREAM_READER
+#if CACHED_BITSTREAM_READER
+
+/* reload the cache if it does not hold MIN_CACHE_BITS bits from _index,
+ * otherwise drop the bits skipped by SKIP_COUNTER() alone */
+# define CACHE_NEEDS_RELOAD(name)                                           \
+    ((int)(name ## _cache_end - name ## _index) < MIN_CACHE_BITS ||         \
+     name ## _index < name ## _cache_pos)
+
+# define UPDATE_CACHE_LE(name, gb)                                          \
+    do {                                                                    \
+        if (CACHE_NEEDS_RELOAD(name)) {                                     \
+            name ## _cache     = AV_RL64((gb)->buffer + (name ## _index >> 3)) \
+                                 >> (name ## _index & 7);                   \
+            name ## _cache_end = (name ## _index & ~7) + 64;                \
+        } else                                                              \
+            name ## _cache >>= name ## _index - name ## _cache_pos;         \
+        name ## _cache_pos = name ## _index;                                \
+    } while (0)
+
+# define UPDATE_CACHE_BE(name, gb)                                          \
+    do {                                                                    \
+        if (CACHE_NEEDS_RELOAD(name)) {                                     \
+            name ## _cache     = AV_RB64((gb)->buffer + (name ## _index >> 3)) \
+                                 << (name ## _index & 7);                   \
+            name ## _cache_end = (name ## _index & ~7) + 64;                \
+        } else                                                              \
+            name ## _cache <<= name ## _index - name ## _cache_pos;         \
+        name ## _cache_pos = name ## _index;                                \
+    } while (0)
+
+#elif defined(LONG_BITSTREAM_READER)
 
 # define UPDATE_CACHE_LE(name, gb) name ## _cache = \
       AV_RL64((gb)->buffer + (name ## _index >> 3)) >> (name ## _index & 7)
@@ -150,17 +206,25 @@ typedef struct GetBitContext {
 #endif
 
 
+#if CACHED_BITSTREAM_READER
+# define SKIP_CACHE_POS(name, num) , name ## _cache_pos += (num)
+#else
+# define SKIP_CACHE_POS(name, num)
+#endif
+
 #ifdef BITSTREAM_READER_LE
 
 # define UPDATE_CACHE(name, gb) UPDATE_CACHE_LE(name, gb)
 
-# define SKIP_CACHE(name, gb, num) name ## _cache >>= (num)
+# define SKIP_CACHE(name, gb, num) \
+    (name ## _cache >>= (num) SKIP_CACHE_POS(name, num))
 
 #else
 
 # define UPDATE_CACHE(name, gb) UPDATE_CACHE_BE(name, gb)
 
-# define SKIP_CACHE(name, gb, num) name ## _cache <<= (num)
+# define SKIP_CACHE(name, gb, num) \
+    (name ## _cache <<= (num) SKIP_CACHE_POS(name, num))
 
 #endif
 
@@ -184,8 +248,15 @@ typedef struct GetBitContext {
 #define SHOW_UBITS_LE(name, gb, num) zero_extend(name ## _cache, num)
 #define SHOW_SBITS_LE(name, gb, num) sign_extend(name ## _cache, num)
 
+#if CACHED_BITSTREAM_READER
+#define SHOW_UBITS_BE(name, gb, num) \
+    ((uint32_t)(name ## _cache >> (64 - (num))))
+#define SHOW_SBITS_BE(name, gb, num) \
+    ((int32_t)((int64_t)name ## _cache >> (64 - (num))))
+#else
 #define SHOW_UBITS_BE(name, gb, num) NEG_USR32(name ## _cache, num)
 #define SHOW_SBITS_BE(name, gb, num) NEG_SSR32(name ## _cache, num)
+#endif
 
 #ifdef BITSTREAM_READER_LE
 #   define SHOW_UBITS(name, gb, num) SHOW_UBITS_LE(name, gb, num)
@@ -195,7 +266,11 @@ typedef struct GetBitContext {
 #   define SHOW_SBITS(name, gb, num) SHOW_SBITS_BE(name, gb, num)
 #endif
 
+#if CACHED_BITSTREAM_READER && !defined(BITSTREAM_READER_LE)
+#define GET_CACHE(name, gb) ((uint32_t)(name ## _cache >> 32))
+#else
 #define GET_CACHE(name, gb) ((uint32_t) name ## _cache)
+#endif
 
 static inline int get_bits_count(const GetBitContext *s)
 {
@@ -29,6 +29,7 @@
 
 #include <limits.h>
 
+#include "libavutil/thread.h"
 #include "avcodec.h"
 #include "mpegvideo.h"
 #include "h263.h"
@@ -306,6 +307,18 @@ void ff_h263_pred_acdc(MpegEncContext * s, int16_t *block, int n)
         ac_val1[8 + i] = block[s->idsp.idct_permutation[i]];
 }
 
+static av_cold void h263_init_rl(void)
+{
+    ff_rl_init(&ff_h263_rl_inter, ff_h263_static_rl_table_store[0]);
+    ff_rl_init(&ff_rl_intra_aic, ff_h263_static_rl_table_store[1]);
+}
+
+av_cold void ff_h263_init_rl(void)
+{
+    static AVOnce init_static_once = AV_ONCE_INIT;
+    ff_thread_once(&init_static_once, h263_init_rl);
+}
+
 int16_t *ff_h263_pred_motion(MpegEncContext * s, int block, int dir,
                              int *px, int *py)
 {
@@ -748,6 +748,7 @@ AVCodec ff_h263_decoder = {
     .flush          = ff_mpeg_flush,
     .max_lowres     = 3,
     .pix_fmts       = ff_h263_hwaccel_pixfmt_list_420,
+    .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
 
 AVCodec ff_h263p_decoder = {
@@ -764,4 +765,5 @@ AVCodec ff_h263p_decoder = {
     .flush          = ff_mpeg_flush,
     .max_lowres     = 3,
     .pix_fmts       = ff_h263_hwaccel_pixfmt_list_420,
+    .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
@@ -328,6 +328,7 @@ av_cold void ff_h264_decode_init_vlc(void){
     static int done = 0;
 
     if (!done) {
+        int64_t start = av_gettime_relative();
         int i;
         int offset;
         done = 1;
@@ -410,6 +411,8 @@ av_cold void ff_h264_decode_init_vlc(void){
                  INIT_VLC_USE_NEW_STATIC);
 
         init_cavlc_level_tab();
+
+        ff_table_init_report("H.264 CAVLC", start);
     }
 }
 
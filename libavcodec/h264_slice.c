@@ -25,6 +25,7 @@
  * @author Michael Niedermayer <michaelni@gmx.at>
  */
 
+#include "libavutil/atomic.h"
 #include "libavutil/avassert.h"
 #include "libavutil/display.h"
 #include "libavutil/imgutils.h"
@@ -2273,6 +2274,8 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
         return;
 
     if (sl->deblocking_filter) {
+        uint64_t t = ff_stage_start(h->avctx);
+
         for (mb_x = start_x; mb_x < end_x; mb_x++)
             for (mb_y = end_mb_y - FRAME_MBAFF(h); mb_y <= end_mb_y; mb_y++) {
                 int mb_xy, mb_type;
@@ -2322,6 +2325,7 @@ static void loop_filter(const H264Context *h, H264SliceContext *sl, int start_x,
                                            dest_cr, linesize, uvlinesize);
                 }
             }
+        ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_LOOP_FILTER, t);
     }
     sl->slice_type  = old_slice_type;
     sl->mb_x         = end_x;
@@ -2350,6 +2354,12 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
     int height         =  16      << FRAME_MBAFF(h);
     int deblock_border = (16 + 4) << FRAME_MBAFF(h);
 
+    if (sl->deblock_pipeline) {
+        /* the loop filter job draws the rows once they are filtered */
+        ff_thread_report_progress2(h->avctx, 0, 0, 1);
+        return;
+    }
+
     if (sl->deblocking_filter) {
         if ((top + height) >= pic_height)
             height += deblock_border;
@@ -2407,7 +2417,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
 
     av_assert0(h->block_offset[15] == (4 * ((scan8[15] - scan8[0]) & 7) << h->pixel_shift) + 4 * sl->linesize * ((scan8[15] - scan8[0]) >> 3));
 
-    if (h->postpone_filter)
+    if (h->postpone_filter || sl->deblock_pipeline)
         sl->deblocking_filter = 0;
 
     sl->is_complex = FRAME_MBAFF(h) || h->picture_structure != PICT_FRAME ||
@@ -2437,7 +2447,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
         ff_h264_init_cabac_states(h, sl);
 
         for (;;) {
-            // START_TIMER
+            uint64_t t = ff_stage_start(h->avctx);
             int ret, eos;
             if (sl->mb_x + sl->mb_y * h->mb_width >= sl->next_slice_idx) {
                 av_log(h->avctx, AV_LOG_ERROR, "Slice overlaps with next at %d\n",
@@ -2448,19 +2458,24 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
             }
 
             ret = ff_h264_decode_mb_cabac(h, sl);
-            // STOP_TIMER("decode_mb_cabac")
+            t   = ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_ENTROPY, t);
 
-            if (ret >= 0)
+            if (ret >= 0) {
                 ff_h264_hl_decode_mb(h, sl);
+                t = ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_RECON, t);
+            }
 
             // FIXME optimal? or let mb_decode decode 16x32 ?
             if (ret >= 0 && FRAME_MBAFF(h)) {
                 sl->mb_y++;
 
                 ret = ff_h264_decode_mb_cabac(h, sl);
+                t   = ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_ENTROPY, t);
 
-                if (ret >= 0)
+                if (ret >= 0) {
                     ff_h264_hl_decode_mb(h, sl);
+                    ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_RECON, t);
+                }
                 sl->mb_y--;
             }
             eos = get_cabac_terminate(&sl->cabac);
@@ -2509,6 +2524,7 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
         }
     } else {
         for (;;) {
+            uint64_t t = ff_stage_start(h->avctx);
             int ret;
 
             if (sl->mb_x + sl->mb_y * h->mb_width >= sl->next_slice_idx) {
@@ -2520,17 +2536,23 @@ static int decode_slice(struct AVCodecContext *avctx, void *arg)
             }
 
             ret = ff_h264_decode_mb_cavlc(h, sl);
+            t   = ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_ENTROPY, t);
 
-            if (ret >= 0)
+            if (ret >= 0) {
                 ff_h264_hl_decode_mb(h, sl);
+                t = ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_RECON, t);
+            }
 
             // FIXME optimal? or let mb_decode decode 16x32 ?
             if (ret >= 0 && FRAME_MBAFF(h)) {
                 sl->mb_y++;
                 ret = ff_h264_decode_mb_cavlc(h, sl);
+                t   = ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_ENTROPY, t);
 
-                if (ret >= 0)
+                if (ret >= 0) {
                     ff_h264_hl_decode_mb(h, sl);
+                    ff_stage_stop(&sl->stage_timing, AV_CODEC_STAGE_RECON, t);
+                }
                 sl->mb_y--;
             }
 
@@ -2597,6 +2619,98 @@ finish:
     return 0;
 }
 
+/**
+ * Deblocking pipeline for pictures made of a single slice: job 0 decodes the
+ * slice without filtering, like with postpone_filter, while job 1 runs the
+ * loop filter on the rows whose lower neighbour is already decoded, so that
+ * intra prediction still sees unfiltered samples. The jobs record their
+ * stage times in their own slice context, job 0 the entropy decoding and
+ * reconstruction and job 1 the loop filter, like separate slices.
+ */
+static int decode_slice_pipelined(AVCodecContext *avctx, void *arg,
+                                  int jobnr, int threadnr)
+{
+    H264Context *h       = arg;
+    H264SliceContext *sl = &h->slice_ctx[0];
+    H264SliceContext *lf = &h->slice_ctx[1];
+    const int step       = 1 + FIELD_OR_MBAFF_PICTURE(h);
+    int ret, j, y_end, x_end;
+
+    if (!jobnr) {
+        ret = decode_slice(avctx, sl);
+        if (ret < 0)
+            sl->mb_x = 0; // the loop filter skips the incomplete row
+        avpriv_atomic_int_set(&h->pipeline_done, 1);
+        ff_thread_report_progress2(avctx, 0, 0, h->mb_height);
+        return ret;
+    }
+
+    for (j = lf->resync_mb_y; j < h->mb_height; j += step) {
+        /* wait until the next row is decoded */
+        ff_thread_await_progress2(avctx, 1, 1, 2);
+        if (avpriv_atomic_int_get(&h->pipeline_done))
+            break;
+
+        lf->mb_y = j;
+        loop_filter(h, lf, 0, h->mb_width);
+        decode_finish_row(h, lf);
+        ff_thread_report_progress2(avctx, 1, 0, 1);
+    }
+
+    /* filter what is left once the decoding is over */
+    y_end = FFMIN(sl->mb_y + 1, h->mb_height);
+    x_end = (sl->mb_y >= h->mb_height) ? h->mb_width : sl->mb_x;
+    for (; j < y_end; j += step) {
+        lf->mb_y = j;
+        if (j == y_end - 1 && x_end < h->mb_width) {
+            if (x_end)
+                loop_filter(h, lf, 0, x_end);
+        } else {
+            loop_filter(h, lf, 0, h->mb_width);
+            decode_finish_row(h, lf);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Set up the loop filter context of the deblocking pipeline from the
+ * decoding one.
+ */
+static void init_deblock_context(const H264Context *h, H264SliceContext *lf,
+                                 const H264SliceContext *sl)
+{
+    lf->slice_num              = sl->slice_num;
+    lf->slice_type             = sl->slice_type;
+    lf->list_count             = sl->list_count;
+    lf->qscale                 = sl->qscale;
+    lf->qp_thresh              = sl->qp_thresh;
+    lf->mb_mbaff               = sl->mb_mbaff;
+    lf->mb_field_decoding_flag = sl->mb_field_decoding_flag;
+    lf->deblocking_filter      = sl->deblocking_filter;
+    lf->slice_alpha_c0_offset  = sl->slice_alpha_c0_offset;
+    lf->slice_beta_offset      = sl->slice_beta_offset;
+    lf->resync_mb_y            = sl->resync_mb_y;
+    lf->linesize               = h->cur_pic_ptr->f->linesize[0];
+    lf->uvlinesize             = h->cur_pic_ptr->f->linesize[1];
+    /* the unfiltered borders are needed by the following slices */
+    lf->top_borders[0]         = sl->top_borders[0];
+    lf->top_borders[1]         = sl->top_borders[1];
+}
+
+/**
+ * Add the stage times recorded by the slice contexts to the codec ones.
+ */
+static void merge_stage_timing(H264Context *h)
+{
+    int i;
+
+    for (i = 0; i < h->nb_slice_ctx; i++)
+        ff_stage_timing_add(&h->avctx->internal->stage_timing,
+                            &h->slice_ctx[i].stage_timing);
+}
+
 /**
  * Call decode_slice() for each context.
  *
@@ -2625,8 +2739,35 @@ int ff_h264_execute_decode_slices(H264Context *h, unsigned context_count)
         h->slice_ctx[0].next_slice_idx = h->mb_width * h->mb_height;
         h->postpone_filter = 0;
 
-        ret = decode_slice(avctx, &h->slice_ctx[0]);
-        h->mb_y = h->slice_ctx[0].mb_y;
+        sl = &h->slice_ctx[0];
+        if (h->deblock_pipeline && h->nb_slice_ctx > 1 &&
+            (avctx->active_thread_type & FF_THREAD_SLICE) &&
+            sl->deblocking_filter && !sl->first_mb_addr && !FRAME_MBAFF(h)) {
+            H264SliceContext *lf = &h->slice_ctx[1];
+            void *top_borders[2] = { lf->top_borders[0], lf->top_borders[1] };
+            int rets[2];
+
+            ret = alloc_scratch_buffers(sl, h->cur_pic_ptr->f->linesize[0]);
+            if (ret >= 0)
+                ret = ff_alloc_entries(avctx, 2);
+            if (ret < 0)
+                return ret;
+
+            init_deblock_context(h, lf, sl);
+            sl->deblock_pipeline = 1;
+            h->pipeline_done     = 0;
+
+            avctx->execute2(avctx, decode_slice_pipelined, h, rets, 2);
+
+            sl->deblock_pipeline = 0;
+            lf->top_borders[0]   = top_borders[0];
+            lf->top_borders[1]   = top_borders[1];
+            ret = rets[0];
+        } else {
+            ret = decode_slice(avctx, sl);
+        }
+        h->mb_y = sl->mb_y;
+        merge_stage_timing(h);
         return ret;
     } else {
         av_assert0(context_count > 0);
@@ -2680,6 +2821,7 @@ int ff_h264_execute_decode_slices(H264Context *h, unsigned context_count)
                 }
             }
         }
+        merge_stage_timing(h);
     }
 
     return 0;
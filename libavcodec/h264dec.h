@@ -197,6 +197,9 @@ typedef struct H264SliceContext {
     int deblocking_filter;          ///< disable_deblocking_filter_idc with 1 <-> 0
     int slice_alpha_c0_offset;
     int slice_beta_offset;
+    /* Set when the loop filter is run by a separate job, some rows behind
+     * the decoding, see decode_slice_pipelined(). */
+    int deblock_pipeline;
 
     H264PredWeightTable pwt;
 
@@ -333,6 +336,8 @@ typedef struct H264SliceContext {
     int delta_poc[2];
     int curr_pic_num;
     int max_pic_num;
+
+    FFStageTiming stage_timing;
 } H264SliceContext;
 
 /**
@@ -381,6 +386,8 @@ typedef struct H264Context {
      * during normal MB decoding and execute it serially at the end.
      */
     int postpone_filter;
+    /* Set by the decoding job of the deblocking pipeline when it is done. */
+    int pipeline_done;
 
     /*
      * Set to 1 when the current picture is IDR, 0 otherwise.
@@ -555,6 +562,7 @@ typedef struct H264Context {
     int16_t slice_row[MAX_SLICES]; ///< to detect when MAX_SLICES is too low
 
     int enable_er;
+    int deblock_pipeline;
 
     H264SEIContext sei;
 
@@ -31,6 +31,8 @@
  */
 
 #define UNCHECKED_BITSTREAM_READER 1
+/* the rows are read in long OPEN_READER() spans */
+#define CACHED_BITSTREAM_READER 1
 
 #include "avcodec.h"
 #include "get_bits.h"
@@ -32,6 +32,7 @@
 #include "libavutil/pixfmt.h"
 #include "avcodec.h"
 #include "config.h"
+#include "stage_timing.h"
 
 /**
  * The codec does not modify any global variables in the init function,
@@ -174,6 +175,11 @@ typedef struct AVCodecInternal {
     AVFrame *buffer_frame;
     int draining_done;
     int showed_multi_packet_warning;
+
+    /**
+     * Time spent in each stage, when AVCodecContext.stage_timing is set.
+     */
+    FFStageTiming stage_timing;
 } AVCodecInternal;
 
 struct AVCodecDefault {
@@ -203,6 +209,17 @@ extern volatile int ff_avcodec_locked;
 int ff_lock_avcodec(AVCodecContext *log_ctx, const AVCodec *codec);
 int ff_unlock_avcodec(const AVCodec *codec);
 
+/**
+ * Report the time spent building the static tables called name, at
+ * AV_LOG_DEBUG level, along with the total spent in all the tables so far.
+ * Meant to be called at the end of the ff_thread_once() routines, so that
+ * the startup cost of each table can be seen with -loglevel debug.
+ *
+ * @param start time at which the initialization started,
+ *              as returned by av_gettime_relative()
+ */
+void ff_table_init_report(const char *name, int64_t start);
+
 int avpriv_lock_avformat(void);
 int avpriv_unlock_avformat(void);
 
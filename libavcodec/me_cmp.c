@@ -502,6 +502,30 @@ void ff_set_cmp(MECmpContext *c, me_cmp_func *cmp, int type)
     }
 }
 
+static void sad16_x4_c(MpegEncContext *s, uint8_t *blk1,
+                       uint8_t *const cand[4], ptrdiff_t stride, int h,
+                       int scores[4])
+{
+    scores[0] = pix_abs16_c(s, blk1, cand[0], stride, h);
+    scores[1] = pix_abs16_c(s, blk1, cand[1], stride, h);
+    scores[2] = pix_abs16_c(s, blk1, cand[2], stride, h);
+    scores[3] = pix_abs16_c(s, blk1, cand[3], stride, h);
+}
+
+void ff_set_cmp_x4(MECmpContext *c, me_cmp_x4_func *cmp, int type)
+{
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        /* The C version is only the reference for the SIMD ones, the
+         * callers are as fast comparing the candidates one by one. */
+        if ((type & 0xFF) == FF_CMP_SAD && c->sad_x4[i] != sad16_x4_c)
+            cmp[i] = c->sad_x4[i];
+        else
+            cmp[i] = NULL;
+    }
+}
+
 #define BUTTERFLY2(o1, o2, i1, i2)              \
     o1 = (i1) + (i2);                           \
     o2 = (i1) - (i2);
@@ -1056,6 +1080,8 @@ av_cold void ff_me_cmp_init(MECmpContext *c, AVCodecContext *avctx)
     ff_dsputil_init_dwt(c);
 #endif
 
+    c->sad_x4[0] = sad16_x4_c;
+
     if (ARCH_ALPHA)
         ff_me_cmp_init_alpha(c, avctx);
     if (ARCH_ARM)
@@ -50,6 +50,15 @@ typedef int (*me_cmp_func)(struct MpegEncContext *c,
                            uint8_t *blk2 /* align 1 */, ptrdiff_t stride,
                            int h);
 
+/**
+ * Compare blk1 against 4 candidate blocks at once, as if me_cmp_func was
+ * called for each of them, and store the results in scores.
+ */
+typedef void (*me_cmp_x4_func)(struct MpegEncContext *c,
+                               uint8_t *blk1 /* align width (8 or 16) */,
+                               uint8_t *const cand[4] /* align 1 */,
+                               ptrdiff_t stride, int h, int scores[4]);
+
 typedef struct MECmpContext {
     int (*sum_abs_dctelem)(int16_t *block /* align 16 */);
 
@@ -77,6 +86,11 @@ typedef struct MECmpContext {
 
     me_cmp_func pix_abs[2][4];
     me_cmp_func median_sad[6];
+
+    /* batched version, only width 16 ([0]) is implemented */
+    me_cmp_x4_func sad_x4[6];
+
+    me_cmp_x4_func me_cmp_x4[6];
 } MECmpContext;
 
 void ff_me_cmp_init_static(void);
@@ -91,6 +105,11 @@ void ff_me_cmp_init_x86(MECmpContext *c, AVCodecContext *avctx);
 void ff_me_cmp_init_mips(MECmpContext *c, AVCodecContext *avctx);
 
 void ff_set_cmp(MECmpContext *c, me_cmp_func *cmp, int type);
+/**
+ * Select the batched comparison functions matching type, or NULL when there
+ * is no SIMD version for it.
+ */
+void ff_set_cmp_x4(MECmpContext *c, me_cmp_x4_func *cmp, int type);
 
 void ff_dsputil_init_dwt(MECmpContext *c);
 
@@ -272,6 +272,38 @@ static av_always_inline int cmp(MpegEncContext *s, const int x, const int y, con
     }
 }
 
+/**
+ * Compare the block against n <= 4 full-pel candidate vectors, using the
+ * batched comparison function if there is one.
+ * Only valid for flags without FLAG_DIRECT and FLAG_CHROMA.
+ */
+static void cmp_fpel_x4(MpegEncContext *s, int (*mv)[2], int n, int *scores,
+                        const int size, const int h, int ref_index, int src_index,
+                        me_cmp_func cmp_func, me_cmp_x4_func cmp_x4_func){
+    MotionEstContext * const c= &s->me;
+    const int stride= c->stride;
+    uint8_t * const ref= c->ref[ref_index][0];
+    uint8_t * const src= c->src[src_index][0];
+    int i;
+
+    if(cmp_x4_func && n > 1){
+        uint8_t *cand[4];
+        int tmp[4];
+
+        /* pad the batch by repeating the last candidate */
+        for(i=0; i<4; i++){
+            const int j= FFMIN(i, n - 1);
+            cand[i]= ref + mv[j][0] + mv[j][1]*stride;
+        }
+        cmp_x4_func(s, src, cand, stride, h, tmp);
+        for(i=0; i<n; i++)
+            scores[i]= tmp[i];
+    }else{
+        for(i=0; i<n; i++)
+            scores[i]= cmp_func(s, src, ref + mv[i][0] + mv[i][1]*stride, stride, h);
+    }
+}
+
 static int cmp_hpel(MpegEncContext *s, const int x, const int y, const int subx, const int suby,
                       const int size, const int h, int ref_index, int src_index,
                       me_cmp_func cmp_func, me_cmp_func chroma_cmp_func, const int flags){
@@ -346,6 +378,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     ff_set_cmp(&s->mecc, s->mecc.me_cmp,     c->avctx->me_cmp);
     ff_set_cmp(&s->mecc, s->mecc.me_sub_cmp, c->avctx->me_sub_cmp);
     ff_set_cmp(&s->mecc, s->mecc.mb_cmp,     c->avctx->mb_cmp);
+    ff_set_cmp_x4(&s->mecc, s->mecc.me_cmp_x4, c->avctx->me_cmp);
 
     c->flags    = get_flags(c, 0, c->avctx->me_cmp    &FF_CMP_CHROMA);
     c->sub_flags= get_flags(c, 0, c->avctx->me_sub_cmp&FF_CMP_CHROMA);
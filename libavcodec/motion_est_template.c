@@ -401,6 +401,55 @@ static int qpel_motion_search(MpegEncContext * s,
     }\
 }
 
+/* Full-pel candidates are collected in batches of up to 4, which are compared
+ * at once by cmp_fpel_x4(). The map is updated when a candidate is added to
+ * the batch and the scores are processed in order when it is flushed, so the
+ * search takes the same decisions as with CHECK_MV_DIR. */
+#define LOAD_BATCH\
+    me_cmp_x4_func cmpf_x4= s->mecc.me_cmp_x4[size];\
+    const int batch= !(flags&(FLAG_DIRECT|FLAG_CHROMA));\
+    int batch_mv[4][2], batch_index[4], batch_dir[4];\
+    int batch_n= 0;\
+
+#define FLUSH_MV_BATCH\
+    if(batch_n){\
+        int batch_score[4], i;\
+        cmp_fpel_x4(s, batch_mv, batch_n, batch_score, size, h, ref_index, src_index, cmpf, cmpf_x4);\
+        for(i=0; i<batch_n; i++){\
+            const int bx= batch_mv[i][0];\
+            const int by= batch_mv[i][1];\
+            int d= batch_score[i];\
+            score_map[batch_index[i]]= d;\
+            d += (mv_penalty[(int)((unsigned)bx<<shift)-pred_x] + mv_penalty[(int)((unsigned)by<<shift)-pred_y])*penalty_factor;\
+            if(d<dmin){\
+                best[0]=bx;\
+                best[1]=by;\
+                dmin=d;\
+                next_dir= batch_dir[i];\
+            }\
+        }\
+        batch_n= 0;\
+    }
+
+#define BATCH_MV_DIR(x,y,new_dir)\
+if(batch){\
+    const unsigned key = ((unsigned)(y)<<ME_MAP_MV_BITS) + (x) + map_generation;\
+    const int index= (((unsigned)(y)<<ME_MAP_SHIFT) + (x))&(ME_MAP_SIZE-1);\
+    av_assert2((x) >= xmin);\
+    av_assert2((x) <= xmax);\
+    av_assert2((y) >= ymin);\
+    av_assert2((y) <= ymax);\
+    if(map[index]!=key){\
+        map[index]= key;\
+        batch_mv[batch_n][0]= x;\
+        batch_mv[batch_n][1]= y;\
+        batch_index[batch_n]= index;\
+        batch_dir[batch_n]= new_dir;\
+        if(++batch_n == 4)\
+            FLUSH_MV_BATCH\
+    }\
+}else CHECK_MV_DIR(x,y,new_dir)
+
 #define check(x,y,S,v)\
 if( (x)<(xmin<<(S)) ) av_log(NULL, AV_LOG_ERROR, "%d %d %d %d %d xmin" #v, xmin, (x), (y), s->mb_x, s->mb_y);\
 if( (x)>(xmax<<(S)) ) av_log(NULL, AV_LOG_ERROR, "%d %d %d %d %d xmax" #v, xmax, (x), (y), s->mb_x, s->mb_y);\
@@ -421,6 +470,7 @@ static av_always_inline int small_diamond_search(MpegEncContext * s, int *best,
     int next_dir=-1;
     LOAD_COMMON
     LOAD_COMMON2
+    LOAD_BATCH
     unsigned map_generation = c->map_generation;
 
     cmpf        = s->mecc.me_cmp[size];
@@ -442,10 +492,11 @@ static av_always_inline int small_diamond_search(MpegEncContext * s, int *best,
         const int y= best[1];
         next_dir=-1;
 
-        if(dir!=2 && x>xmin) CHECK_MV_DIR(x-1, y  , 0)
-        if(dir!=3 && y>ymin) CHECK_MV_DIR(x  , y-1, 1)
-        if(dir!=0 && x<xmax) CHECK_MV_DIR(x+1, y  , 2)
-        if(dir!=1 && y<ymax) CHECK_MV_DIR(x  , y+1, 3)
+        if(dir!=2 && x>xmin) BATCH_MV_DIR(x-1, y  , 0)
+        if(dir!=3 && y>ymin) BATCH_MV_DIR(x  , y-1, 1)
+        if(dir!=0 && x<xmax) BATCH_MV_DIR(x+1, y  , 2)
+        if(dir!=1 && y<ymax) BATCH_MV_DIR(x  , y+1, 3)
+        FLUSH_MV_BATCH
 
         if(next_dir==-1){
             return dmin;
@@ -774,8 +825,10 @@ static int var_diamond_search(MpegEncContext * s, int *best, int dmin,
     MotionEstContext * const c= &s->me;
     me_cmp_func cmpf, chroma_cmpf;
     int dia_size;
+    int av_unused next_dir;
     LOAD_COMMON
     LOAD_COMMON2
+    LOAD_BATCH
     unsigned map_generation = c->map_generation;
 
     cmpf        = s->mecc.me_cmp[size];
@@ -792,7 +845,7 @@ static int var_diamond_search(MpegEncContext * s, int *best, int dmin,
             int d;
 
 //check(x + dir,y + dia_size - dir,0, a0)
-            CHECK_MV(x + dir           , y + dia_size - dir);
+            BATCH_MV_DIR(x + dir           , y + dia_size - dir, -1)
         }
 
         start= FFMAX(0, x + dia_size - xmax);
@@ -801,7 +854,7 @@ static int var_diamond_search(MpegEncContext * s, int *best, int dmin,
             int d;
 
 //check(x + dia_size - dir, y - dir,0, a1)
-            CHECK_MV(x + dia_size - dir, y - dir           );
+            BATCH_MV_DIR(x + dia_size - dir, y - dir, -1)
         }
 
         start= FFMAX(0, -y + dia_size + ymin );
@@ -810,7 +863,7 @@ static int var_diamond_search(MpegEncContext * s, int *best, int dmin,
             int d;
 
 //check(x - dir,y - dia_size + dir,0, a2)
-            CHECK_MV(x - dir           , y - dia_size + dir);
+            BATCH_MV_DIR(x - dir           , y - dia_size + dir, -1)
         }
 
         start= FFMAX(0, -x + dia_size + xmin );
@@ -819,9 +872,11 @@ static int var_diamond_search(MpegEncContext * s, int *best, int dmin,
             int d;
 
 //check(x - dia_size + dir, y + dir,0, a3)
-            CHECK_MV(x - dia_size + dir, y + dir           );
+            BATCH_MV_DIR(x - dia_size + dir, y + dir, -1)
         }
 
+        FLUSH_MV_BATCH
+
         if(x!=best[0] || y!=best[1])
             dia_size=0;
     }
@@ -29,6 +29,7 @@
 
 #include "libavutil/attributes.h"
 #include "libavutil/avassert.h"
+#include "libavutil/thread.h"
 #include "libavutil/timecode.h"
 
 #include "internal.h"
@@ -141,41 +142,56 @@ VLC ff_mb_ptype_vlc;
 VLC ff_mb_btype_vlc;
 VLC ff_mb_pat_vlc;
 
+static av_cold void mpeg12_init_rl(void)
+{
+    ff_rl_init(&ff_rl_mpeg1, ff_mpeg12_static_rl_table_store[0]);
+    ff_rl_init(&ff_rl_mpeg2, ff_mpeg12_static_rl_table_store[1]);
+}
+
+av_cold void ff_mpeg12_init_rl(void)
+{
+    static AVOnce init_static_once = AV_ONCE_INIT;
+    ff_thread_once(&init_static_once, mpeg12_init_rl);
+}
+
+static av_cold void mpeg12_init_vlcs(void)
+{
+    int64_t start = av_gettime_relative();
+
+    INIT_VLC_STATIC(&ff_dc_lum_vlc, DC_VLC_BITS, 12,
+                    ff_mpeg12_vlc_dc_lum_bits, 1, 1,
+                    ff_mpeg12_vlc_dc_lum_code, 2, 2, 512);
+    INIT_VLC_STATIC(&ff_dc_chroma_vlc,  DC_VLC_BITS, 12,
+                    ff_mpeg12_vlc_dc_chroma_bits, 1, 1,
+                    ff_mpeg12_vlc_dc_chroma_code, 2, 2, 514);
+    INIT_VLC_STATIC(&ff_mv_vlc, MV_VLC_BITS, 17,
+                    &ff_mpeg12_mbMotionVectorTable[0][1], 2, 1,
+                    &ff_mpeg12_mbMotionVectorTable[0][0], 2, 1, 518);
+    INIT_VLC_STATIC(&ff_mbincr_vlc, MBINCR_VLC_BITS, 36,
+                    &ff_mpeg12_mbAddrIncrTable[0][1], 2, 1,
+                    &ff_mpeg12_mbAddrIncrTable[0][0], 2, 1, 538);
+    INIT_VLC_STATIC(&ff_mb_pat_vlc, MB_PAT_VLC_BITS, 64,
+                    &ff_mpeg12_mbPatTable[0][1], 2, 1,
+                    &ff_mpeg12_mbPatTable[0][0], 2, 1, 512);
+
+    INIT_VLC_STATIC(&ff_mb_ptype_vlc, MB_PTYPE_VLC_BITS, 7,
+                    &table_mb_ptype[0][1], 2, 1,
+                    &table_mb_ptype[0][0], 2, 1, 64);
+    INIT_VLC_STATIC(&ff_mb_btype_vlc, MB_BTYPE_VLC_BITS, 11,
+                    &table_mb_btype[0][1], 2, 1,
+                    &table_mb_btype[0][0], 2, 1, 64);
+    ff_mpeg12_init_rl();
+
+    INIT_2D_VLC_RL(ff_rl_mpeg1, 680);
+    INIT_2D_VLC_RL(ff_rl_mpeg2, 674);
+
+    ff_table_init_report("MPEG-1/2 VLC", start);
+}
+
 av_cold void ff_mpeg12_init_vlcs(void)
 {
-    static int done = 0;
-
-    if (!done) {
-        done = 1;
-
-        INIT_VLC_STATIC(&ff_dc_lum_vlc, DC_VLC_BITS, 12,
-                        ff_mpeg12_vlc_dc_lum_bits, 1, 1,
-                        ff_mpeg12_vlc_dc_lum_code, 2, 2, 512);
-        INIT_VLC_STATIC(&ff_dc_chroma_vlc,  DC_VLC_BITS, 12,
-                        ff_mpeg12_vlc_dc_chroma_bits, 1, 1,
-                        ff_mpeg12_vlc_dc_chroma_code, 2, 2, 514);
-        INIT_VLC_STATIC(&ff_mv_vlc, MV_VLC_BITS, 17,
-                        &ff_mpeg12_mbMotionVectorTable[0][1], 2, 1,
-                        &ff_mpeg12_mbMotionVectorTable[0][0], 2, 1, 518);
-        INIT_VLC_STATIC(&ff_mbincr_vlc, MBINCR_VLC_BITS, 36,
-                        &ff_mpeg12_mbAddrIncrTable[0][1], 2, 1,
-                        &ff_mpeg12_mbAddrIncrTable[0][0], 2, 1, 538);
-        INIT_VLC_STATIC(&ff_mb_pat_vlc, MB_PAT_VLC_BITS, 64,
-                        &ff_mpeg12_mbPatTable[0][1], 2, 1,
-                        &ff_mpeg12_mbPatTable[0][0], 2, 1, 512);
-
-        INIT_VLC_STATIC(&ff_mb_ptype_vlc, MB_PTYPE_VLC_BITS, 7,
-                        &table_mb_ptype[0][1], 2, 1,
-                        &table_mb_ptype[0][0], 2, 1, 64);
-        INIT_VLC_STATIC(&ff_mb_btype_vlc, MB_BTYPE_VLC_BITS, 11,
-                        &table_mb_btype[0][1], 2, 1,
-                        &table_mb_btype[0][0], 2, 1, 64);
-        ff_rl_init(&ff_rl_mpeg1, ff_mpeg12_static_rl_table_store[0]);
-        ff_rl_init(&ff_rl_mpeg2, ff_mpeg12_static_rl_table_store[1]);
-
-        INIT_2D_VLC_RL(ff_rl_mpeg1, 680);
-        INIT_2D_VLC_RL(ff_rl_mpeg2, 674);
-    }
+    static AVOnce init_static_once = AV_ONCE_INIT;
+    ff_thread_once(&init_static_once, mpeg12_init_vlcs);
 }
 
 /**
@@ -29,6 +29,12 @@ extern uint8_t ff_mpeg12_static_rl_table_store[2][2][2*MAX_RUN + MAX_LEVEL + 3];
 
 void ff_mpeg12_common_init(MpegEncContext *s);
 
+/**
+ * Initialize ff_rl_mpeg1 and ff_rl_mpeg2, shared by the encoder and the
+ * decoder.
+ */
+void ff_mpeg12_init_rl(void);
+
 static inline int decode_dc(GetBitContext *gb, int component)
 {
     int code, diff;
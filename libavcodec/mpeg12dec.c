@@ -2870,7 +2870,8 @@ AVCodec ff_mpeg1video_decoder = {
                              AV_CODEC_CAP_SLICE_THREADS,
     .flush                 = flush,
     .max_lowres            = 3,
-    .update_thread_context = ONLY_IF_THREADS_ENABLED(mpeg_decode_update_thread_context)
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(mpeg_decode_update_thread_context),
+    .caps_internal         = FF_CODEC_CAP_INIT_THREADSAFE,
 };
 
 AVCodec ff_mpeg2video_decoder = {
@@ -2888,6 +2889,7 @@ AVCodec ff_mpeg2video_decoder = {
     .flush          = flush,
     .max_lowres     = 3,
     .profiles       = NULL_IF_CONFIG_SMALL(ff_mpeg2_video_profiles),
+    .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
 
 //legacy decoder
@@ -2903,6 +2905,7 @@ AVCodec ff_mpegvideo_decoder = {
     .capabilities   = AV_CODEC_CAP_DRAW_HORIZ_BAND | AV_CODEC_CAP_DR1 | AV_CODEC_CAP_TRUNCATED | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_SLICE_THREADS,
     .flush          = flush,
     .max_lowres     = 3,
+    .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
 
 #if FF_API_XVMC
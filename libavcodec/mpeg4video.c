@@ -20,6 +20,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/thread.h"
 #include "mpegutils.h"
 #include "mpegvideo.h"
 #include "mpeg4video.h"
@@ -27,6 +28,17 @@
 
 uint8_t ff_mpeg4_static_rl_table_store[3][2][2 * MAX_RUN + MAX_LEVEL + 3];
 
+static av_cold void mpeg4_init_rl_intra(void)
+{
+    ff_rl_init(&ff_mpeg4_rl_intra, ff_mpeg4_static_rl_table_store[0]);
+}
+
+av_cold void ff_mpeg4_init_rl_intra(void)
+{
+    static AVOnce init_static_once = AV_ONCE_INIT;
+    ff_thread_once(&init_static_once, mpeg4_init_rl_intra);
+}
+
 int ff_mpeg4_get_video_packet_prefix_length(MpegEncContext *s)
 {
     switch (s->pict_type) {
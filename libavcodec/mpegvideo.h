@@ -564,6 +564,8 @@ typedef struct MpegEncContext {
 
     int scenechange_threshold;
     int noise_reduction;
+
+    FFStageTiming stage_timing;
 } MpegEncContext;
 
 /* mpegvideo_enc common options */
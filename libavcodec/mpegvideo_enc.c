@@ -2674,6 +2674,7 @@ static inline void encode_mb_hq(MpegEncContext *s, MpegEncContext *backup, MpegE
                            PutBitContext pb[2], PutBitContext pb2[2], PutBitContext tex_pb[2],
                            int *dmin, int *next_block, int motion_x, int motion_y)
 {
+    uint64_t t = ff_stage_start(s->avctx);
     int score;
     uint8_t *dest_backup[3];
 
@@ -2719,6 +2720,8 @@ static inline void encode_mb_hq(MpegEncContext *s, MpegEncContext *backup, MpegE
 
         copy_context_after_encode(best, s, type);
     }
+
+    ff_stage_stop(&s->stage_timing, AV_CODEC_STAGE_RDO, t);
 }
 
 static int sse(MpegEncContext *s, uint8_t *src1, uint8_t *src2, int w, int h, int stride){
@@ -2786,6 +2789,7 @@ static int pre_estimate_motion_thread(AVCodecContext *c, void *arg){
 
 static int estimate_motion_thread(AVCodecContext *c, void *arg){
     MpegEncContext *s= *(void**)arg;
+    uint64_t t;
 
     ff_check_alignment();
 
@@ -2801,10 +2805,12 @@ static int estimate_motion_thread(AVCodecContext *c, void *arg){
             s->block_index[3]+=2;
 
             /* compute motion vector & mb_type and store in context */
+            t = ff_stage_start(s->avctx);
             if(s->pict_type==AV_PICTURE_TYPE_B)
                 ff_estimate_b_frame_motion(s, s->mb_x, s->mb_y);
             else
                 ff_estimate_p_frame_motion(s, s->mb_x, s->mb_y);
+            ff_stage_stop(&s->stage_timing, AV_CODEC_STAGE_ME, t);
         }
         s->first_slice_line=0;
     }
@@ -3589,6 +3595,7 @@ static void merge_context_after_me(MpegEncContext *dst, MpegEncContext *src){
     MERGE(me.scene_change_score);
     MERGE(me.mc_mb_var_sum_temp);
     MERGE(me.mb_var_sum_temp);
+    ff_stage_timing_add(&dst->stage_timing, &src->stage_timing);
 }
 
 static void merge_context_after_encode(MpegEncContext *dst, MpegEncContext *src){
@@ -3609,6 +3616,7 @@ static void merge_context_after_encode(MpegEncContext *dst, MpegEncContext *src)
     MERGE(current_picture.encoding_error[0]);
     MERGE(current_picture.encoding_error[1]);
     MERGE(current_picture.encoding_error[2]);
+    ff_stage_timing_add(&dst->stage_timing, &src->stage_timing);
 
     if (dst->noise_reduction){
         for(i=0; i<64; i++){
@@ -3945,6 +3953,7 @@ static int encode_picture(MpegEncContext *s, int picture_number)
             set_put_bits_buffer_size(&s->pb, FFMIN(s->thread_context[i]->pb.buf_end - s->pb.buf, INT_MAX/8-32));
         merge_context_after_encode(s, s->thread_context[i]);
     }
+    ff_stage_timing_add(&s->avctx->internal->stage_timing, &s->stage_timing);
     emms_c();
     return 0;
 }
@@ -551,6 +551,9 @@ static const AVOption avcodec_options[] = {
 {"codec_whitelist", "List of decoders that are allowed to be used", OFFSET(codec_whitelist), AV_OPT_TYPE_STRING, { .str = NULL },  CHAR_MIN, CHAR_MAX, A|V|S|D },
 {"pixel_format", "set pixel format", OFFSET(pix_fmt), AV_OPT_TYPE_PIXEL_FMT, {.i64=AV_PIX_FMT_NONE}, -1, INT_MAX, 0 },
 {"video_size", "set video size", OFFSET(width), AV_OPT_TYPE_IMAGE_SIZE, {.str=NULL}, 0, INT_MAX, 0 },
+{"thread_max_delay", "maximum delay added by frame threading, in frames (0 = no limit)", OFFSET(thread_max_delay), AV_OPT_TYPE_INT, {.i64 = 0 }, 0, INT_MAX, V|D },
+{"thread_max_delay_ms", "maximum delay added by frame threading, in milliseconds (0 = no limit)", OFFSET(thread_max_delay_ms), AV_OPT_TYPE_INT, {.i64 = 0 }, 0, INT_MAX, V|D },
+{"stage_timing", "record the time spent in each stage of the coding process", OFFSET(stage_timing), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, V|A|E|D },
 {NULL},
 };
 
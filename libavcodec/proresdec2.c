@@ -34,6 +34,7 @@
 #include "idctdsp.h"
 #include "internal.h"
 #include "simple_idct.h"
+#include "thread.h"
 #include "proresdec.h"
 #include "proresdata.h"
 
@@ -430,13 +431,15 @@ static int decode_slice_chroma(AVCodecContext *avctx, SliceContext *slice,
     return 0;
 }
 
-static void unpack_alpha(GetBitContext *gb, uint16_t *dst, int num_coeffs,
-                         const int num_bits)
+static av_always_inline void unpack_alpha(GetBitContext *gb, uint16_t *dst,
+                                          ptrdiff_t dst_stride, int width,
+                                          int height, const int num_bits)
 {
     const int mask = (1 << num_bits) - 1;
-    int i, idx, val, alpha_val;
+    int i, n, x, y, val, alpha_val, pixel;
 
-    idx       = 0;
+    x         = 0;
+    y         = 0;
     alpha_val = mask;
     do {
         do {
@@ -452,27 +455,39 @@ static void unpack_alpha(GetBitContext *gb, uint16_t *dst, int num_coeffs,
             }
             alpha_val = (alpha_val + val) & mask;
             if (num_bits == 16) {
-                dst[idx++] = alpha_val >> 6;
+                dst[x] = alpha_val >> 6;
             } else {
-                dst[idx++] = (alpha_val << 2) | (alpha_val >> 6);
+                dst[x] = (alpha_val << 2) | (alpha_val >> 6);
+            }
+            if (++x == width) {
+                x    = 0;
+                dst += dst_stride;
+                if (++y == height)
+                    return;
             }
-            if (idx >= num_coeffs)
-                break;
         } while (get_bits_left(gb)>0 && get_bits1(gb));
         val = get_bits(gb, 4);
         if (!val)
             val = get_bits(gb, 11);
-        if (idx + val > num_coeffs)
-            val = num_coeffs - idx;
-        if (num_bits == 16) {
-            for (i = 0; i < val; i++)
-                dst[idx++] = alpha_val >> 6;
-        } else {
-            for (i = 0; i < val; i++)
-                dst[idx++] = (alpha_val << 2) | (alpha_val >> 6);
-
+        if (num_bits == 16)
+            pixel = alpha_val >> 6;
+        else
+            pixel = (alpha_val << 2) | (alpha_val >> 6);
+        /* runs are usually long, fill them a line at a time */
+        while (val > 0) {
+            n = FFMIN(val, width - x);
+            for (i = 0; i < n; i++)
+                dst[x + i] = pixel;
+            val -= n;
+            x   += n;
+            if (x == width) {
+                x    = 0;
+                dst += dst_stride;
+                if (++y == height)
+                    return;
+            }
         }
-    } while (idx < num_coeffs);
+    } while (1);
 }
 
 /**
@@ -481,29 +496,16 @@ static void unpack_alpha(GetBitContext *gb, uint16_t *dst, int num_coeffs,
 static void decode_slice_alpha(ProresContext *ctx,
                                uint16_t *dst, int dst_stride,
                                const uint8_t *buf, int buf_size,
-                               int blocks_per_slice)
+                               int mb_count)
 {
     GetBitContext gb;
-    int i;
-    LOCAL_ALIGNED_16(int16_t, blocks, [8*4*64]);
-    int16_t *block;
-
-    for (i = 0; i < blocks_per_slice<<2; i++)
-        ctx->bdsp.clear_block(blocks+(i<<6));
 
     init_get_bits(&gb, buf, buf_size << 3);
 
     if (ctx->alpha_info == 2) {
-        unpack_alpha(&gb, blocks, blocks_per_slice * 4 * 64, 16);
+        unpack_alpha(&gb, dst, dst_stride >> 1, 16 * mb_count, 16, 16);
     } else {
-        unpack_alpha(&gb, blocks, blocks_per_slice * 4 * 64, 8);
-    }
-
-    block = blocks;
-    for (i = 0; i < 16; i++) {
-        memcpy(dst, block, 16 * blocks_per_slice * sizeof(*dst));
-        dst   += dst_stride >> 1;
-        block += 16 * blocks_per_slice;
+        unpack_alpha(&gb, dst, dst_stride >> 1, 16 * mb_count, 16, 8);
     }
 }
 
@@ -633,6 +635,7 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
                         AVPacket *avpkt)
 {
     ProresContext *ctx = avctx->priv_data;
+    ThreadFrame tframe = { .f = data };
     AVFrame *frame = data;
     const uint8_t *buf = avpkt->data;
     int buf_size = avpkt->size;
@@ -658,7 +661,7 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
     buf += frame_hdr_size;
     buf_size -= frame_hdr_size;
 
-    if ((ret = ff_get_buffer(avctx, frame, 0)) < 0)
+    if ((ret = ff_thread_get_buffer(avctx, &tframe, 0)) < 0)
         return ret;
 
  decode_picture:
@@ -704,5 +707,6 @@ AVCodec ff_prores_decoder = {
     .init           = decode_init,
     .close          = decode_close,
     .decode         = decode_frame,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
 };
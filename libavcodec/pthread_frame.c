@@ -42,6 +42,7 @@
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 /**
  * Context used by codec threads and stored in their AVCodecInternal thread_ctx.
@@ -95,6 +96,12 @@ typedef struct PerThreadContext {
     enum AVPixelFormat result_format;            ///< get_format() result
 
     int die;                        ///< Set when the thread should exit.
+
+    /* activity of the thread, protected by progress_mutex */
+    int64_t busy_time;              ///< Total time spent in decode(), in microseconds.
+    int64_t decode_start;           ///< Start time of the running decode() call, 0 if idle.
+    int64_t last_decode_time;       ///< Duration of the last decode() call.
+    int     nb_frames;              ///< Number of decode() calls.
 } PerThreadContext;
 
 /**
@@ -113,6 +120,15 @@ typedef struct FrameThreadContext {
                                     * Set for the first N packets, where N is the number of threads.
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
+
+    int active_threads;            /**<
+                                    * Number of threads packets are submitted to, at most thread_count.
+                                    * Adapted to the decoding time if a maximum delay is set.
+                                    */
+    int growing;                   ///< Set when a thread was added, the next call returns no frame.
+    int64_t decode_time;           ///< Moving average of the time taken to decode a frame.
+    int64_t frame_duration;        ///< Duration of a frame, from the frame rate or the packets.
+    int64_t start_time;            ///< Time the threads were started.
 } FrameThreadContext;
 
 #define THREAD_SAFE_CALLBACKS(avctx) \
@@ -143,6 +159,11 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
 
         av_frame_unref(p->frame);
         p->got_frame = 0;
+
+        pthread_mutex_lock(&p->progress_mutex);
+        p->decode_start = av_gettime_relative();
+        pthread_mutex_unlock(&p->progress_mutex);
+
         p->result = codec->decode(avctx, p->frame, &p->got_frame, &p->avpkt);
 
         if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
@@ -164,6 +185,11 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
 #endif
         p->state = STATE_INPUT_READY;
 
+        p->last_decode_time = av_gettime_relative() - p->decode_start;
+        p->busy_time       += p->last_decode_time;
+        p->decode_start     = 0;
+        p->nb_frames++;
+
         pthread_cond_broadcast(&p->progress_cond);
         pthread_cond_signal(&p->output_cond);
         pthread_mutex_unlock(&p->progress_mutex);
@@ -383,6 +409,68 @@ static int submit_packet(PerThreadContext *p, AVPacket *avpkt)
     return 0;
 }
 
+/**
+ * Compute the number of threads to use so that decoding keeps up with the
+ * frame rate, within the delay allowed by the user.
+ * At least two threads are always used, as codecs expect consecutive
+ * packets to be decoded by different threads.
+ */
+static int target_thread_count(AVCodecContext *avctx, FrameThreadContext *fctx)
+{
+    int max_threads = avctx->thread_count;
+    int64_t duration = fctx->frame_duration;
+
+    if (avctx->thread_max_delay > 0)
+        max_threads = FFMIN(max_threads, avctx->thread_max_delay + 1LL);
+    if (avctx->thread_max_delay_ms > 0 && duration > 0)
+        max_threads = FFMIN(max_threads, avctx->thread_max_delay_ms * 1000LL / duration + 1);
+    max_threads = FFMAX(max_threads, 2);
+
+    if (!fctx->decode_time)
+        return FFMIN(fctx->active_threads, max_threads);
+    if (duration <= 0)
+        return max_threads;
+
+    return av_clip((fctx->decode_time + duration - 1) / duration, 2, max_threads);
+}
+
+static void update_frame_duration(AVCodecContext *avctx, FrameThreadContext *fctx,
+                                  const AVPacket *avpkt)
+{
+    if (avctx->framerate.num > 0 && avctx->framerate.den > 0)
+        fctx->frame_duration = av_rescale(AV_TIME_BASE, avctx->framerate.den,
+                                          avctx->framerate.num);
+    else if (avpkt->duration > 0 && avctx->pkt_timebase.num > 0 &&
+             avctx->pkt_timebase.den > 0)
+        fctx->frame_duration = av_rescale_q(avpkt->duration, avctx->pkt_timebase,
+                                            AV_TIME_BASE_Q);
+}
+
+int ff_thread_get_stats(AVCodecContext *avctx, AVCodecThreadStats *stats, int nb_stats)
+{
+    FrameThreadContext *fctx = avctx->internal->thread_ctx;
+    int64_t now = av_gettime_relative();
+    int i;
+
+    for (i = 0; i < FFMIN(avctx->thread_count, nb_stats); i++) {
+        PerThreadContext *p    = &fctx->threads[i];
+        AVCodecThreadStats *st = &stats[i];
+        int64_t busy;
+
+        pthread_mutex_lock(&p->progress_mutex);
+        busy = p->busy_time;
+        if (p->decode_start)
+            busy += now - p->decode_start;
+        st->nb_frames = p->nb_frames;
+        pthread_mutex_unlock(&p->progress_mutex);
+
+        st->busy_time = busy;
+        st->idle_time = FFMAX(now - fctx->start_time - busy, 0);
+        st->active    = i < fctx->active_threads;
+    }
+    return avctx->thread_count;
+}
+
 int ff_thread_decode_frame(AVCodecContext *avctx,
                            AVFrame *picture, int *got_picture_ptr,
                            AVPacket *avpkt)
@@ -402,14 +490,32 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
     err = submit_packet(p, avpkt);
     if (err) return err;
 
+    if (avpkt->size)
+        update_frame_duration(avctx, fctx, avpkt);
+
     /*
      * If we're still receiving the initial packets, don't return a frame.
      */
 
-    if (fctx->next_decoding > (avctx->thread_count-1-(avctx->codec_id == AV_CODEC_ID_FFV1)))
+    if (fctx->next_decoding > (fctx->active_threads-1-(avctx->codec_id == AV_CODEC_ID_FFV1)))
         fctx->delaying = 0;
 
-    if (fctx->delaying) {
+    /*
+     * Threads can only be added at the end of the ring, once the last one
+     * received its packet, so that the output order is kept. No frame is
+     * returned for the packet that makes room for the new thread, which is
+     * what adds the extra delay.
+     */
+    if (fctx->next_decoding >= fctx->active_threads) {
+        if (avpkt->size && fctx->active_threads < target_thread_count(avctx, fctx)) {
+            fctx->active_threads++;
+            fctx->growing = 1;
+        } else
+            fctx->next_decoding = 0;
+    }
+
+    if (fctx->delaying || fctx->growing) {
+        fctx->growing = 0;
         *got_picture_ptr=0;
         if (avpkt->size)
             return avpkt->size;
@@ -436,6 +542,15 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
         *got_picture_ptr = p->got_frame;
         picture->pkt_dts = p->avpkt.dts;
 
+        ff_stage_timing_add(&avctx->internal->stage_timing,
+                            &p->avctx->internal->stage_timing);
+
+        pthread_mutex_lock(&p->progress_mutex);
+        fctx->decode_time = fctx->decode_time ?
+                            (fctx->decode_time * 7 + p->last_decode_time) / 8 :
+                            p->last_decode_time;
+        pthread_mutex_unlock(&p->progress_mutex);
+
         if (p->result < 0)
             err = p->result;
 
@@ -447,13 +562,11 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
          */
         p->got_frame = 0;
 
-        if (finished >= avctx->thread_count) finished = 0;
+        if (finished >= fctx->active_threads) finished = 0;
     } while (!avpkt->size && !*got_picture_ptr && finished != fctx->next_finished);
 
     update_context_from_thread(avctx, p->avctx, 1);
 
-    if (fctx->next_decoding >= avctx->thread_count) fctx->next_decoding = 0;
-
     fctx->next_finished = finished;
 
     /*
@@ -641,6 +754,9 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 
     pthread_mutex_init(&fctx->buffer_mutex, NULL);
     fctx->delaying = 1;
+    fctx->active_threads = avctx->thread_max_delay > 0 || avctx->thread_max_delay_ms > 0 ?
+                           2 : thread_count;
+    fctx->start_time = av_gettime_relative();
 
     for (i = 0; i < thread_count; i++) {
         AVCodecContext *copy = av_malloc(sizeof(AVCodecContext));
@@ -730,7 +846,11 @@ void ff_thread_flush(AVCodecContext *avctx)
 
     fctx->next_decoding = fctx->next_finished = 0;
     fctx->delaying = 1;
+    fctx->growing  = 0;
     fctx->prev_thread = NULL;
+    /* the ring is empty, so this is the only place it can shrink */
+    if (avctx->thread_max_delay > 0 || avctx->thread_max_delay_ms > 0)
+        fctx->active_threads = target_thread_count(avctx, fctx);
     for (i = 0; i < avctx->thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
         // Make sure decode flush calls with size=0 won't return old frames
@@ -28,6 +28,7 @@
 #define AVCODEC_RANGECODER_H
 
 #include <stdint.h>
+#include <string.h>
 
 #include "libavutil/common.h"
 #include "libavutil/avassert.h"
@@ -51,27 +52,36 @@ void ff_build_rac_states(RangeCoder *c, int factor, int max_p);
 
 static inline void renorm_encoder(RangeCoder *c)
 {
-    // FIXME: optimize
-    while (c->range < 0x100) {
-        if (c->outstanding_byte < 0) {
-            c->outstanding_byte = c->low >> 8;
-        } else if (c->low <= 0xFF00) {
-            *c->bytestream++ = c->outstanding_byte;
-            for (; c->outstanding_count; c->outstanding_count--)
-                *c->bytestream++ = 0xFF;
-            c->outstanding_byte = c->low >> 8;
-        } else if (c->low >= 0x10000) {
-            *c->bytestream++ = c->outstanding_byte + 1;
-            for (; c->outstanding_count; c->outstanding_count--)
-                *c->bytestream++ = 0x00;
-            c->outstanding_byte = (c->low >> 8) & 0xFF;
-        } else {
-            c->outstanding_count++;
+    /* put_rac() leaves at least 1 in range, so a single byte is always
+     * enough to renormalize */
+    if (c->range >= 0x100)
+        return;
+
+    if (c->outstanding_byte < 0) {
+        c->outstanding_byte = c->low >> 8;
+    } else if (c->low <= 0xFF00) {
+        *c->bytestream++ = c->outstanding_byte;
+        if (c->outstanding_count) {
+            memset(c->bytestream, 0xFF, c->outstanding_count);
+            c->bytestream       += c->outstanding_count;
+            c->outstanding_count = 0;
         }
-
-        c->low     = (c->low & 0xFF) << 8;
-        c->range <<= 8;
+        c->outstanding_byte = c->low >> 8;
+    } else if (c->low >= 0x10000) {
+        *c->bytestream++ = c->outstanding_byte + 1;
+        if (c->outstanding_count) {
+            memset(c->bytestream, 0x00, c->outstanding_count);
+            c->bytestream       += c->outstanding_count;
+            c->outstanding_count = 0;
+        }
+        c->outstanding_byte = (c->low >> 8) & 0xFF;
+    } else {
+        c->outstanding_count++;
     }
+
+    c->low     = (c->low & 0xFF) << 8;
+    c->range <<= 8;
+    av_assert2(c->range >= 0x100);
 }
 
 static inline int get_rac_count(RangeCoder *c)
@@ -0,0 +1,96 @@
+/*
+ * Per-stage timing of the coding process
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_STAGE_TIMING_H
+#define AVCODEC_STAGE_TIMING_H
+
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/time.h"
+#include "libavutil/timer.h"
+
+#include "avcodec.h"
+
+/**
+ * Time spent in each stage, see AVCodecContext.stage_timing.
+ *
+ * Contexts used by several threads at once keep one of these per thread,
+ * and add it to the AVCodecInternal one with ff_stage_timing_add() once
+ * the threads are done.
+ */
+typedef struct FFStageTiming {
+    uint64_t time[AV_CODEC_STAGE_NB];
+    uint64_t count[AV_CODEC_STAGE_NB];
+} FFStageTiming;
+
+static av_always_inline uint64_t ff_stage_read_time(void)
+{
+#ifdef AV_READ_TIME
+    return AV_READ_TIME();
+#else
+    return av_gettime_relative();
+#endif
+}
+
+/**
+ * Start timing a stage.
+ * @return the start time, or 0 if timing is disabled for avctx
+ */
+static av_always_inline uint64_t ff_stage_start(const AVCodecContext *avctx)
+{
+    return avctx->stage_timing ? ff_stage_read_time() : 0;
+}
+
+/**
+ * Account the time elapsed since start to stage.
+ * @return the current time, to start timing the following stage,
+ *         or 0 if timing is disabled
+ */
+static av_always_inline uint64_t ff_stage_stop(FFStageTiming *t,
+                                               enum AVCodecStage stage,
+                                               uint64_t start)
+{
+    uint64_t now;
+
+    if (!start)
+        return 0;
+
+    now = ff_stage_read_time();
+    t->time[stage] += now - start;
+    t->count[stage]++;
+    return now;
+}
+
+/**
+ * Add the times in src to dst and reset src.
+ */
+static inline void ff_stage_timing_add(FFStageTiming *dst, FFStageTiming *src)
+{
+    int i;
+
+    for (i = 0; i < AV_CODEC_STAGE_NB; i++) {
+        dst->time[i]  += src->time[i];
+        dst->count[i] += src->count[i];
+        src->time[i]   = src->count[i] = 0;
+    }
+}
+
+#endif /* AVCODEC_STAGE_TIMING_H */
@@ -0,0 +1,226 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that the default and the cached bitstream readers decode the same
+ * symbols, and with any argument, compare their speed:
+ *   libavcodec/tests/get_bits bench
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#include "libavcodec/put_bits.h"
+
+#define FUNC(name) name ## _default
+#include "get_bits_template.c"
+
+unsigned read_vlc_cached(const uint8_t *buf, int size, const VLC *vlc, int count);
+unsigned read_golomb_cached(const uint8_t *buf, int size, int count);
+unsigned read_rice_cached(const uint8_t *buf, int size, int count);
+unsigned read_bits_cached(const uint8_t *buf, int size, int count);
+
+#define COUNT (1 << 16)
+#define SIZE  (1 << 20)
+#define RUNS  200
+
+/* number of codes of each length, an incomplete prefix code */
+static const uint8_t vlc_len_count[17] = {
+    0, 0, 1, 2, 3, 4, 6, 8, 0, 8, 0, 8, 0, 8, 0, 0, 8,
+};
+
+#define NB_SYMBOLS 56
+
+typedef struct Stream {
+    const char *name;
+    uint8_t *buf;
+    int size;
+    unsigned sum;
+} Stream;
+
+static void finish_stream(Stream *s, PutBitContext *pb)
+{
+    flush_put_bits(pb);
+    s->size = put_bits_count(pb) >> 3;
+}
+
+static void gen_vlc(Stream *s, AVLFG *lfg, VLC *vlc)
+{
+    uint8_t  lens[NB_SYMBOLS];
+    uint16_t codes[NB_SYMBOLS];
+    unsigned weight_sum = 0, code = 0;
+    PutBitContext pb;
+    int i, len, n = 0;
+
+    /* canonical code, the shortest codes for the lowest symbols */
+    for (len = 1; len <= 16; len++) {
+        for (i = 0; i < vlc_len_count[len]; i++) {
+            lens[n]    = len;
+            codes[n++] = code++;
+        }
+        code <<= 1;
+    }
+    for (i = 0; i < NB_SYMBOLS; i++)
+        weight_sum += 1 << (16 - lens[i]);
+
+    init_vlc(vlc, TEST_VLC_BITS, NB_SYMBOLS, lens, 1, 1, codes, 2, 2, 0);
+
+    init_put_bits(&pb, s->buf, SIZE);
+    s->sum = 0;
+    for (i = 0; i < COUNT; i++) {
+        unsigned r = av_lfg_get(lfg) % weight_sum;
+        int sym = 0, val;
+
+        /* each symbol about as frequent as its code length implies */
+        while (r >= 1 << (16 - lens[sym]))
+            r -= 1 << (16 - lens[sym++]);
+        put_bits(&pb, lens[sym], codes[sym]);
+        val = sym;
+        if (sym) {
+            int sign = av_lfg_get(lfg) & 1;
+            put_bits(&pb, 1, sign);
+            val = sign ? -sym : sym;
+        }
+        s->sum = s->sum * 31 + val;
+    }
+    finish_stream(s, &pb);
+}
+
+static void gen_golomb(Stream *s, AVLFG *lfg)
+{
+    PutBitContext pb;
+    int i;
+
+    init_put_bits(&pb, s->buf, SIZE);
+    s->sum = 0;
+    for (i = 0; i < COUNT; i++) {
+        int val = (int)(av_lfg_get(lfg) % 129) - 64;
+        val >>= av_lfg_get(lfg) % 6;
+        set_se_golomb(&pb, val);
+        s->sum = s->sum * 31 + val;
+    }
+    finish_stream(s, &pb);
+}
+
+static void gen_rice(Stream *s, AVLFG *lfg)
+{
+    PutBitContext pb;
+    int i;
+
+    init_put_bits(&pb, s->buf, SIZE);
+    s->sum = 0;
+    for (i = 0; i < COUNT; i++) {
+        int val = (int)(av_lfg_get(lfg) % 257) - 128;
+        set_sr_golomb_flac(&pb, val, TEST_RICE_K, INT_MAX, 0);
+        s->sum = s->sum * 31 + val;
+    }
+    finish_stream(s, &pb);
+}
+
+static void gen_bits(Stream *s, AVLFG *lfg)
+{
+    PutBitContext pb;
+    int i;
+
+    init_put_bits(&pb, s->buf, SIZE);
+    s->sum = 0;
+    for (i = 0; i < COUNT; i++) {
+        int len = TEST_BITS_LEN(i);
+        unsigned val = av_lfg_get(lfg) & ((1 << len) - 1);
+        put_bits(&pb, len, val);
+        s->sum = s->sum * 31 + val;
+    }
+    finish_stream(s, &pb);
+}
+
+static unsigned read_stream(const Stream *s, const VLC *vlc, int cached)
+{
+    switch (s->name[0]) {
+    case 'v': return cached ? read_vlc_cached   (s->buf, s->size, vlc, COUNT)
+                            : read_vlc_default  (s->buf, s->size, vlc, COUNT);
+    case 'g': return cached ? read_golomb_cached(s->buf, s->size, COUNT)
+                            : read_golomb_default(s->buf, s->size, COUNT);
+    case 'r': return cached ? read_rice_cached  (s->buf, s->size, COUNT)
+                            : read_rice_default (s->buf, s->size, COUNT);
+    default:  return cached ? read_bits_cached  (s->buf, s->size, COUNT)
+                            : read_bits_default (s->buf, s->size, COUNT);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Stream streams[] = {
+        { "vlc" }, { "golomb" }, { "rice" }, { "bits" },
+    };
+    VLC vlc = { 0 };
+    AVLFG lfg;
+    int i, j, ret = 0;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(streams); i++) {
+        streams[i].buf = av_mallocz(SIZE + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (!streams[i].buf)
+            return 1;
+    }
+    gen_vlc   (&streams[0], &lfg, &vlc);
+    gen_golomb(&streams[1], &lfg);
+    gen_rice  (&streams[2], &lfg);
+    gen_bits  (&streams[3], &lfg);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(streams); i++) {
+        Stream *s = &streams[i];
+
+        for (j = 0; j < 2; j++) {
+            unsigned sum = read_stream(s, &vlc, j);
+            if (sum != s->sum) {
+                fprintf(stderr, "%s: %s reader mismatch\n", s->name,
+                        j ? "cached" : "default");
+                ret = 1;
+            }
+        }
+
+        if (argc > 1) {
+            int64_t time[2];
+
+            for (j = 0; j < 2; j++) {
+                int64_t start = av_gettime_relative();
+                int run;
+
+                for (run = 0; run < RUNS; run++)
+                    read_stream(s, &vlc, j);
+                time[j] = av_gettime_relative() - start;
+            }
+            printf("%-6s default %6.2f ns/code, cached %6.2f ns/code (%+.1f%%)\n",
+                   s->name, time[0] * 1000.0 / (RUNS * COUNT),
+                   time[1] * 1000.0 / (RUNS * COUNT),
+                   (time[1] - time[0]) * 100.0 / time[0]);
+        }
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(streams); i++)
+        av_free(streams[i].buf);
+    ff_free_vlc(&vlc);
+
+    return ret;
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Decoding loops of the get_bits test, modelled after the hot loops of the
+ * decoders, built once with each bitstream reader.
+ * FUNC(name) must be defined by the including file.
+ */
+
+#include "libavcodec/get_bits.h"
+#include "libavcodec/golomb.h"
+
+#define TEST_VLC_BITS 9
+#define TEST_RICE_K   4
+#define TEST_BITS_LEN(i) (1 + (i) % 16)
+
+unsigned FUNC(read_vlc)(const uint8_t *buf, int size, const VLC *vlc, int count);
+unsigned FUNC(read_golomb)(const uint8_t *buf, int size, int count);
+unsigned FUNC(read_rice)(const uint8_t *buf, int size, int count);
+unsigned FUNC(read_bits)(const uint8_t *buf, int size, int count);
+
+/* a block decoding loop, as in the MPEG-1/2, DNxHD and ProRes decoders */
+unsigned FUNC(read_vlc)(const uint8_t *buf, int size, const VLC *vlc, int count)
+{
+    GetBitContext gb;
+    unsigned sum = 0;
+    int i;
+
+    init_get_bits8(&gb, buf, size);
+    {
+        OPEN_READER(re, &gb);
+        for (i = 0; i < count; i++) {
+            int code;
+
+            UPDATE_CACHE(re, &gb);
+            GET_VLC(code, re, &gb, vlc->table, TEST_VLC_BITS, 2);
+            if (code) {
+                code = (code ^ SHOW_SBITS(re, &gb, 1)) - SHOW_SBITS(re, &gb, 1);
+                LAST_SKIP_BITS(re, &gb, 1);
+            }
+            sum = sum * 31 + code;
+        }
+        CLOSE_READER(re, &gb);
+    }
+    return sum;
+}
+
+/* Exp-Golomb codes, as in the H.264 CAVLC and the parameter sets */
+unsigned FUNC(read_golomb)(const uint8_t *buf, int size, int count)
+{
+    GetBitContext gb;
+    unsigned sum = 0;
+    int i;
+
+    init_get_bits8(&gb, buf, size);
+    for (i = 0; i < count; i++)
+        sum = sum * 31 + get_se_golomb(&gb);
+    return sum;
+}
+
+/* Rice codes, as in the FLAC residual */
+unsigned FUNC(read_rice)(const uint8_t *buf, int size, int count)
+{
+    GetBitContext gb;
+    unsigned sum = 0;
+    int i;
+
+    init_get_bits8(&gb, buf, size);
+    for (i = 0; i < count; i++)
+        sum = sum * 31 + get_sr_golomb_flac(&gb, TEST_RICE_K, INT_MAX, 0);
+    return sum;
+}
+
+/* fixed length fields */
+unsigned FUNC(read_bits)(const uint8_t *buf, int size, int count)
+{
+    GetBitContext gb;
+    unsigned sum = 0;
+    int i;
+
+    init_get_bits8(&gb, buf, size);
+    for (i = 0; i < count; i++)
+        sum = sum * 31 + get_bits(&gb, TEST_BITS_LEN(i));
+    return sum;
+}
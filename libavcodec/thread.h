@@ -135,6 +135,13 @@ int ff_thread_ref_frame(ThreadFrame *dst, ThreadFrame *src);
 int ff_thread_init(AVCodecContext *s);
 void ff_thread_free(AVCodecContext *s);
 
+/**
+ * Fill stats with the activity of the frame threads.
+ *
+ * @return the number of frame threads
+ */
+int ff_thread_get_stats(AVCodecContext *avctx, AVCodecThreadStats *stats, int nb_stats);
+
 int ff_alloc_entries(AVCodecContext *avctx, int count);
 void ff_reset_entries(AVCodecContext *avctx);
 void ff_thread_report_progress2(AVCodecContext *avctx, int field, int thread, int n);
@@ -39,6 +39,7 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/mem_internal.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/registry.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/samplefmt.h"
 #include "libavutil/dict.h"
@@ -114,6 +115,7 @@ static int (*lockmgr_cb)(void **mutex, enum AVLockOp op) = NULL;
 
 volatile int ff_avcodec_locked;
 static int volatile entangled_thread_counter = 0;
+static int volatile table_init_time = 0;
 static void *codec_mutex;
 static void *avformat_mutex;
 
@@ -144,6 +146,9 @@ void av_fast_padded_mallocz(void *ptr, unsigned int *size, size_t min_size)
 /* encoder management */
 static AVCodec *first_avcodec = NULL;
 static AVCodec **last_avcodec = &first_avcodec;
+/* registered codecs, indexed by id and by name */
+static FFRegistryIndex codec_id_index;
+static FFRegistryIndex codec_name_index;
 
 AVCodec *av_codec_next(const AVCodec *c)
 {
@@ -186,6 +191,10 @@ av_cold void avcodec_register(AVCodec *codec)
         p = &(*p)->next;
     last_avcodec = &codec->next;
 
+    avpriv_registry_add(&codec_id_index, codec->id, codec);
+    avpriv_registry_add(&codec_name_index,
+                        avpriv_registry_hash(codec->name, SIZE_MAX), codec);
+
     if (codec->init_static_data)
         codec->init_static_data(codec);
 }
@@ -3127,41 +3136,80 @@ static enum AVCodecID remap_deprecated_codec_id(enum AVCodecID id)
 
 static AVCodec *find_encdec(enum AVCodecID id, int encoder)
 {
+    const FFRegistryNode *node;
     AVCodec *p, *experimental = NULL;
-    p = first_avcodec;
     id= remap_deprecated_codec_id(id);
-    while (p) {
-        if ((encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
+
+    if (codec_id_index.incomplete) {
+        p = first_avcodec;
+        while (p) {
+            if ((encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
+                p->id == id) {
+                if (p->capabilities & AV_CODEC_CAP_EXPERIMENTAL && !experimental) {
+                    experimental = p;
+                } else
+                    return p;
+            }
+            p = p->next;
+        }
+        return experimental;
+    }
+
+    for (node = ff_registry_bucket(&codec_id_index, id); node; node = node->next) {
+        p = (AVCodec *)node->item;
+        if (node->key == id &&
+            (encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
             p->id == id) {
             if (p->capabilities & AV_CODEC_CAP_EXPERIMENTAL && !experimental) {
                 experimental = p;
             } else
                 return p;
         }
-        p = p->next;
     }
     return experimental;
 }
 
-AVCodec *avcodec_find_encoder(enum AVCodecID id)
-{
-    return find_encdec(id, 1);
-}
-
-AVCodec *avcodec_find_encoder_by_name(const char *name)
+static AVCodec *find_encdec_by_name(const char *name, int encoder)
 {
+    const FFRegistryNode *node;
     AVCodec *p;
+    uint32_t key;
+
     if (!name)
         return NULL;
-    p = first_avcodec;
-    while (p) {
-        if (av_codec_is_encoder(p) && strcmp(name, p->name) == 0)
+
+    if (codec_name_index.incomplete) {
+        p = first_avcodec;
+        while (p) {
+            if ((encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
+                strcmp(name, p->name) == 0)
+                return p;
+            p = p->next;
+        }
+        return NULL;
+    }
+
+    key = avpriv_registry_hash(name, SIZE_MAX);
+    for (node = ff_registry_bucket(&codec_name_index, key); node; node = node->next) {
+        p = (AVCodec *)node->item;
+        if (node->key == key &&
+            (encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
+            strcmp(name, p->name) == 0)
             return p;
-        p = p->next;
     }
     return NULL;
 }
 
+AVCodec *avcodec_find_encoder(enum AVCodecID id)
+{
+    return find_encdec(id, 1);
+}
+
+AVCodec *avcodec_find_encoder_by_name(const char *name)
+{
+    return find_encdec_by_name(name, 1);
+}
+
 AVCodec *avcodec_find_decoder(enum AVCodecID id)
 {
     return find_encdec(id, 0);
@@ -3169,16 +3217,7 @@ AVCodec *avcodec_find_decoder(enum AVCodecID id)
 
 AVCodec *avcodec_find_decoder_by_name(const char *name)
 {
-    AVCodec *p;
-    if (!name)
-        return NULL;
-    p = first_avcodec;
-    while (p) {
-        if (av_codec_is_decoder(p) && strcmp(name, p->name) == 0)
-            return p;
-        p = p->next;
-    }
-    return NULL;
+    return find_encdec_by_name(name, 0);
 }
 
 const char *avcodec_get_name(enum AVCodecID id)
@@ -3447,6 +3486,41 @@ const char *avcodec_profile_name(enum AVCodecID codec_id, int profile)
     return NULL;
 }
 
+const char *avcodec_stage_name(enum AVCodecStage stage)
+{
+    static const char * const names[AV_CODEC_STAGE_NB] = {
+        [AV_CODEC_STAGE_ENTROPY]     = "entropy",
+        [AV_CODEC_STAGE_RECON]       = "recon",
+        [AV_CODEC_STAGE_LOOP_FILTER] = "loop_filter",
+        [AV_CODEC_STAGE_ME]          = "me",
+        [AV_CODEC_STAGE_RDO]         = "rdo",
+    };
+
+    if ((unsigned)stage >= AV_CODEC_STAGE_NB)
+        return NULL;
+    return names[stage];
+}
+
+int avcodec_get_stage_timing(const AVCodecContext *avctx, enum AVCodecStage stage,
+                             uint64_t *time, uint64_t *count)
+{
+    if ((unsigned)stage >= AV_CODEC_STAGE_NB || !avctx->internal)
+        return AVERROR(EINVAL);
+
+    *time  = avctx->internal->stage_timing.time[stage];
+    *count = avctx->internal->stage_timing.count[stage];
+    return 0;
+}
+
+int avcodec_get_thread_stats(AVCodecContext *avctx, AVCodecThreadStats *stats,
+                             int nb_stats)
+{
+    if (HAVE_THREADS && avcodec_is_open(avctx) &&
+        avctx->active_thread_type & FF_THREAD_FRAME)
+        return ff_thread_get_stats(avctx, stats, nb_stats);
+    return 0;
+}
+
 unsigned avcodec_version(void)
 {
 //    av_assert0(AV_CODEC_ID_V410==164);
@@ -3959,6 +4033,15 @@ int ff_unlock_avcodec(const AVCodec *codec)
     return 0;
 }
 
+void ff_table_init_report(const char *name, int64_t start)
+{
+    int elapsed = av_gettime_relative() - start;
+    int total   = avpriv_atomic_int_add_and_fetch(&table_init_time, elapsed);
+
+    av_log(NULL, AV_LOG_DEBUG, "Initialized %s tables in %d us (%d us total)\n",
+           name, elapsed, total);
+}
+
 int avpriv_lock_avformat(void)
 {
     if (lockmgr_cb) {
@@ -62,6 +62,7 @@ static void free_buffers(VP8Context *s)
     av_freep(&s->intra4x4_pred_mode_top);
     av_freep(&s->top_nnz);
     av_freep(&s->top_border);
+    av_freep(&s->mb_coeffs);
 
     s->macroblocks = NULL;
 }
@@ -1420,9 +1421,9 @@ void decode_mb_coeffs(VP8Context *s, VP8ThreadData *td, VP56RangeCoder *c,
             nnz_total += nnz;
             block_dc   = 1;
             if (nnz == 1)
-                s->vp8dsp.vp8_luma_dc_wht_dc(td->block, td->block_dc);
+                s->vp8dsp.vp8_luma_dc_wht_dc(td->coeffs->block, td->block_dc);
             else
-                s->vp8dsp.vp8_luma_dc_wht(td->block, td->block_dc);
+                s->vp8dsp.vp8_luma_dc_wht(td->coeffs->block, td->block_dc);
         }
         luma_start = 1;
         luma_ctx   = 0;
@@ -1432,14 +1433,14 @@ void decode_mb_coeffs(VP8Context *s, VP8ThreadData *td, VP56RangeCoder *c,
     for (y = 0; y < 4; y++)
         for (x = 0; x < 4; x++) {
             nnz_pred = l_nnz[y] + t_nnz[x];
-            nnz = decode_block_coeffs(c, td->block[y][x],
+            nnz = decode_block_coeffs(c, td->coeffs->block[y][x],
                                       s->prob->token[luma_ctx],
                                       luma_start, nnz_pred,
                                       s->qmat[segment].luma_qmul,
                                       s->prob[0].scan, is_vp7);
             /* nnz+block_dc may be one more than the actual last index,
              * but we don't care */
-            td->non_zero_count_cache[y][x] = nnz + block_dc;
+            td->coeffs->non_zero_count_cache[y][x] = nnz + block_dc;
             t_nnz[x] = l_nnz[y] = !!nnz;
             nnz_total += nnz;
         }
@@ -1451,11 +1452,11 @@ void decode_mb_coeffs(VP8Context *s, VP8ThreadData *td, VP56RangeCoder *c,
         for (y = 0; y < 2; y++)
             for (x = 0; x < 2; x++) {
                 nnz_pred = l_nnz[i + 2 * y] + t_nnz[i + 2 * x];
-                nnz = decode_block_coeffs(c, td->block[i][(y << 1) + x],
+                nnz = decode_block_coeffs(c, td->coeffs->block[i][(y << 1) + x],
                                           s->prob->token[2], 0, nnz_pred,
                                           s->qmat[segment].chroma_qmul,
                                           s->prob[0].scan, is_vp7);
-                td->non_zero_count_cache[i][(y << 1) + x] = nnz;
+                td->coeffs->non_zero_count_cache[i][(y << 1) + x] = nnz;
                 t_nnz[i + 2 * x] = l_nnz[i + 2 * y] = !!nnz;
                 nnz_total += nnz;
             }
@@ -1629,7 +1630,7 @@ void intra_predict(VP8Context *s, VP8ThreadData *td, uint8_t *dst[3],
         }
 
         if (mb->skip)
-            AV_ZERO128(td->non_zero_count_cache);
+            AV_ZERO128(td->coeffs->non_zero_count_cache);
 
         for (y = 0; y < 4; y++) {
             uint8_t *topright = ptr + 4 - s->linesize;
@@ -1679,14 +1680,16 @@ void intra_predict(VP8Context *s, VP8ThreadData *td, uint8_t *dst[3],
                     AV_COPY32(ptr + 4 * x + s->linesize * 3, copy_dst + 36);
                 }
 
-                nnz = td->non_zero_count_cache[y][x];
+                nnz = td->coeffs->non_zero_count_cache[y][x];
                 if (nnz) {
                     if (nnz == 1)
                         s->vp8dsp.vp8_idct_dc_add(ptr + 4 * x,
-                                                  td->block[y][x], s->linesize);
+                                                  td->coeffs->block[y][x],
+                                                  s->linesize);
                     else
                         s->vp8dsp.vp8_idct_add(ptr + 4 * x,
-                                               td->block[y][x], s->linesize);
+                                               td->coeffs->block[y][x],
+                                               s->linesize);
                 }
                 topright += 4;
             }
@@ -1991,24 +1994,24 @@ void idct_mb(VP8Context *s, VP8ThreadData *td, uint8_t *dst[3], VP8Macroblock *m
     if (mb->mode != MODE_I4x4) {
         uint8_t *y_dst = dst[0];
         for (y = 0; y < 4; y++) {
-            uint32_t nnz4 = AV_RL32(td->non_zero_count_cache[y]);
+            uint32_t nnz4 = AV_RL32(td->coeffs->non_zero_count_cache[y]);
             if (nnz4) {
                 if (nnz4 & ~0x01010101) {
                     for (x = 0; x < 4; x++) {
                         if ((uint8_t) nnz4 == 1)
                             s->vp8dsp.vp8_idct_dc_add(y_dst + 4 * x,
-                                                      td->block[y][x],
+                                                      td->coeffs->block[y][x],
                                                       s->linesize);
                         else if ((uint8_t) nnz4 > 1)
                             s->vp8dsp.vp8_idct_add(y_dst + 4 * x,
-                                                   td->block[y][x],
+                                                   td->coeffs->block[y][x],
                                                    s->linesize);
                         nnz4 >>= 8;
                         if (!nnz4)
                             break;
                     }
                 } else {
-                    s->vp8dsp.vp8_idct_dc_add4y(y_dst, td->block[y], s->linesize);
+                    s->vp8dsp.vp8_idct_dc_add4y(y_dst, td->coeffs->block[y], s->linesize);
                 }
             }
             y_dst += 4 * s->linesize;
@@ -2016,7 +2019,7 @@ void idct_mb(VP8Context *s, VP8ThreadData *td, uint8_t *dst[3], VP8Macroblock *m
     }
 
     for (ch = 0; ch < 2; ch++) {
-        uint32_t nnz4 = AV_RL32(td->non_zero_count_cache[4 + ch]);
+        uint32_t nnz4 = AV_RL32(td->coeffs->non_zero_count_cache[4 + ch]);
         if (nnz4) {
             uint8_t *ch_dst = dst[1 + ch];
             if (nnz4 & ~0x01010101) {
@@ -2024,11 +2027,11 @@ void idct_mb(VP8Context *s, VP8ThreadData *td, uint8_t *dst[3], VP8Macroblock *m
                     for (x = 0; x < 2; x++) {
                         if ((uint8_t) nnz4 == 1)
                             s->vp8dsp.vp8_idct_dc_add(ch_dst + 4 * x,
-                                                      td->block[4 + ch][(y << 1) + x],
+                                                      td->coeffs->block[4 + ch][(y << 1) + x],
                                                       s->uvlinesize);
                         else if ((uint8_t) nnz4 > 1)
                             s->vp8dsp.vp8_idct_add(ch_dst + 4 * x,
-                                                   td->block[4 + ch][(y << 1) + x],
+                                                   td->coeffs->block[4 + ch][(y << 1) + x],
                                                    s->uvlinesize);
                         nnz4 >>= 8;
                         if (!nnz4)
@@ -2037,7 +2040,7 @@ void idct_mb(VP8Context *s, VP8ThreadData *td, uint8_t *dst[3], VP8Macroblock *m
                     ch_dst += 4 * s->uvlinesize;
                 }
             } else {
-                s->vp8dsp.vp8_idct_dc_add4uv(ch_dst, td->block[4 + ch], s->uvlinesize);
+                s->vp8dsp.vp8_idct_dc_add4uv(ch_dst, td->coeffs->block[4 + ch], s->uvlinesize);
             }
         }
 chroma_idct_end:
@@ -2292,6 +2295,7 @@ static av_always_inline int decode_mb_row_no_filter(AVCodecContext *avctx, void
     int mb_y = td->thread_mb_pos >> 16;
     int mb_x, mb_xy = mb_y * s->mb_width;
     int num_jobs = s->num_jobs;
+    int token_pipeline = !is_vp7 && s->token_pipeline;
     VP8Frame *curframe = s->curframe, *prev_frame = s->prev_frame;
     VP56RangeCoder *c  = &s->coeff_partition[mb_y & (s->num_coeff_partitions - 1)];
     VP8Macroblock *mb;
@@ -2301,7 +2305,14 @@ static av_always_inline int decode_mb_row_no_filter(AVCodecContext *avctx, void
         curframe->tf.f->data[2] +  8 * mb_y * s->uvlinesize
     };
 
-    if (vpX_rac_is_end(c))
+    if (token_pipeline) {
+        VP8ThreadData *token_td = &s->thread_data[num_jobs];
+
+        // Wait for the token job to finish this row.
+        check_thread_pos(td, token_td, 0xFFFF, mb_y);
+        if (mb_xy >= s->token_mbs)
+            return AVERROR_INVALIDDATA;
+    } else if (vpX_rac_is_end(c))
          return AVERROR_INVALIDDATA;
 
     if (mb_y == 0)
@@ -2332,7 +2343,7 @@ static av_always_inline int decode_mb_row_no_filter(AVCodecContext *avctx, void
     s->mv_max.x = ((s->mb_width - 1) << 6) + MARGIN;
 
     for (mb_x = 0; mb_x < s->mb_width; mb_x++, mb_xy++, mb++) {
-        if (vpX_rac_is_end(c))
+        if (token_pipeline ? mb_xy >= s->token_mbs : vpX_rac_is_end(c))
             return AVERROR_INVALIDDATA;
         // Wait for previous thread to read mb_x+2, and reach mb_y-1.
         if (prev_td != td) {
@@ -2359,7 +2370,9 @@ static av_always_inline int decode_mb_row_no_filter(AVCodecContext *avctx, void
 
         prefetch_motion(s, mb, mb_x, mb_y, mb_xy, VP56_FRAME_PREVIOUS);
 
-        if (!mb->skip)
+        if (token_pipeline)
+            td->coeffs = &s->mb_coeffs[mb_xy];
+        else if (!mb->skip)
             decode_mb_coeffs(s, td, c, mb, s->top_nnz[mb_x], td->left_nnz, is_vp7);
 
         if (mb->mode <= MODE_I4x4)
@@ -2371,7 +2384,7 @@ static av_always_inline int decode_mb_row_no_filter(AVCodecContext *avctx, void
 
         if (!mb->skip) {
             idct_mb(s, td, dst, mb);
-        } else {
+        } else if (!token_pipeline) {
             AV_ZERO64(td->left_nnz);
             AV_WN64(s->top_nnz[mb_x], 0);   // array of 9, so unaligned
 
@@ -2540,6 +2553,71 @@ static int vp8_decode_mb_row_sliced(AVCodecContext *avctx, void *tdata,
     return vp78_decode_mb_row_sliced(avctx, tdata, jobnr, threadnr, IS_VP8);
 }
 
+/**
+ * Decode the tokens of all the rows of a single partition frame into
+ * s->mb_coeffs, so that the reconstruction and loop filter of the rows
+ * can run in the other jobs while the partition is being read.
+ */
+static int vp8_decode_mb_tokens(AVCodecContext *avctx, void *tdata,
+                                int jobnr, int threadnr)
+{
+    VP8Context *s = avctx->priv_data;
+    VP8ThreadData *td = &s->thread_data[jobnr];
+    VP56RangeCoder *c = &s->coeff_partition[0];
+    int mb_x, mb_y, mb_xy = 0, ret = 0;
+
+    for (mb_y = 0; mb_y < s->mb_height && !ret; mb_y++) {
+        VP8Macroblock *mb = s->macroblocks_base +
+                            ((s->mb_width + 1) * (mb_y + 1) + 1);
+
+        memset(td->left_nnz, 0, sizeof(td->left_nnz));
+        for (mb_x = 0; mb_x < s->mb_width; mb_x++, mb_xy++, mb++) {
+            if (vpX_rac_is_end(c)) {
+                ret = AVERROR_INVALIDDATA;
+                break;
+            }
+
+            if (!mb->skip) {
+                td->coeffs = &s->mb_coeffs[mb_xy];
+                decode_mb_coeffs(s, td, c, mb, s->top_nnz[mb_x],
+                                 td->left_nnz, IS_VP8);
+            }
+            if (mb->skip) {
+                AV_ZERO64(td->left_nnz);
+                AV_WN64(s->top_nnz[mb_x], 0);   // array of 9, so unaligned
+
+                /* Reset DC block predictors if they would exist
+                 * if the mb had coefficients */
+                if (mb->mode != MODE_I4x4 && mb->mode != VP8_MVMODE_SPLIT) {
+                    td->left_nnz[8]     = 0;
+                    s->top_nnz[mb_x][8] = 0;
+                }
+            }
+        }
+
+#if HAVE_THREADS
+        pthread_mutex_lock(&td->lock);
+        s->token_mbs = mb_xy;
+        // On error, release the reconstruction jobs waiting for the next rows.
+        td->thread_mb_pos = ((ret < 0 ? s->mb_height : mb_y) << 16) | 0xFFFF;
+        pthread_cond_broadcast(&td->cond);
+        pthread_mutex_unlock(&td->lock);
+#endif
+    }
+
+    return ret;
+}
+
+static int vp8_decode_mb_row_pipelined(AVCodecContext *avctx, void *tdata,
+                                       int jobnr, int threadnr)
+{
+    VP8Context *s = avctx->priv_data;
+
+    if (jobnr == s->num_jobs)
+        return vp8_decode_mb_tokens(avctx, tdata, jobnr, threadnr);
+    return vp78_decode_mb_row_sliced(avctx, tdata, jobnr, threadnr, IS_VP8);
+}
+
 
 static av_always_inline
 int vp78_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
@@ -2664,6 +2742,23 @@ int vp78_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
         num_jobs = 1;
     else
         num_jobs = FFMIN(s->num_coeff_partitions, avctx->thread_count);
+
+    /* With a single partition, decode the tokens in a job of their own
+     * and spread the reconstruction over the remaining threads. */
+    s->token_pipeline = 0;
+    if (!is_vp7 && num_jobs == 1 && s->mb_layout == 1 &&
+        avctx->active_thread_type == FF_THREAD_SLICE &&
+        avctx->thread_count > 1) {
+        if (!s->mb_coeffs)
+            s->mb_coeffs = av_mallocz_array(s->mb_width * s->mb_height,
+                                            sizeof(*s->mb_coeffs));
+        if (s->mb_coeffs) {
+            s->token_pipeline = 1;
+            s->token_mbs      = 0;
+            num_jobs = FFMIN(avctx->thread_count, MAX_THREADS) - 1;
+        }
+    }
+
     s->num_jobs   = num_jobs;
     s->curframe   = curframe;
     s->prev_frame = prev_frame;
@@ -2672,10 +2767,14 @@ int vp78_decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
     for (i = 0; i < MAX_THREADS; i++) {
         s->thread_data[i].thread_mb_pos = 0;
         s->thread_data[i].wait_mb_pos   = INT_MAX;
+        s->thread_data[i].coeffs        = &s->thread_data[i].mb_coeffs;
     }
     if (is_vp7)
         avctx->execute2(avctx, vp7_decode_mb_row_sliced, s->thread_data, NULL,
                         num_jobs);
+    else if (s->token_pipeline)
+        avctx->execute2(avctx, vp8_decode_mb_row_pipelined, s->thread_data,
+                        NULL, num_jobs + 1);
     else
         avctx->execute2(avctx, vp8_decode_mb_row_sliced, s->thread_data, NULL,
                         num_jobs);
@@ -91,9 +91,8 @@ typedef struct VP8Macroblock {
     VP56mv bmv[16];
 } VP8Macroblock;
 
-typedef struct VP8ThreadData {
+typedef struct VP8MBCoeffs {
     DECLARE_ALIGNED(16, int16_t, block)[6][4][16];
-    DECLARE_ALIGNED(16, int16_t, block_dc)[16];
     /**
      * This is the index plus one of the last non-zero coeff
      * for each of the blocks in the current macroblock.
@@ -102,6 +101,17 @@ typedef struct VP8ThreadData {
      *     2+-> full transform
      */
     DECLARE_ALIGNED(16, uint8_t, non_zero_count_cache)[6][4];
+} VP8MBCoeffs;
+
+typedef struct VP8ThreadData {
+    VP8MBCoeffs mb_coeffs;
+    /**
+     * Coefficients of the current macroblock, either mb_coeffs or
+     * an entry of VP8Context.mb_coeffs when the tokens are decoded
+     * by a separate job.
+     */
+    VP8MBCoeffs *coeffs;
+    DECLARE_ALIGNED(16, int16_t, block_dc)[16];
     /**
      * For coeff decode, we need to know whether the above block had non-zero
      * coefficients. This means for each macroblock, we need data for 4 luma
@@ -268,6 +278,16 @@ typedef struct VP8Context {
     uint8_t fullrange;  ///< whether we can skip clamping in dsp functions
 
     int num_jobs;
+
+    /**
+     * Token pipeline for sliced threading of single partition frames:
+     * one job decodes the coefficients of the whole frame into
+     * mb_coeffs, the num_jobs others reconstruct and filter the rows.
+     */
+    int token_pipeline;
+    int token_mbs;       ///< number of macroblocks whose tokens are decoded
+    VP8MBCoeffs *mb_coeffs;
+
     /**
      * This describes the macroblock memory layout.
      * 0 -> Only width+height*2+1 macroblocks allocated (frame/single thread).
@@ -551,6 +551,60 @@ static int sad16_xy2_ ## suf(MpegEncContext *v, uint8_t *blk2,          \
 
 PIX_SAD(mmx)
 
+#if ARCH_X86_64
+static void sad16_x4_sse2(MpegEncContext *v, uint8_t *blk1,
+                          uint8_t *const cand[4], ptrdiff_t stride, int h,
+                          int scores[4])
+{
+    x86_reg len = h;
+    uint8_t *c0 = cand[0], *c1 = cand[1], *c2 = cand[2], *c3 = cand[3];
+
+    __asm__ volatile (
+        "pxor        %%xmm4, %%xmm4     \n\t"
+        "pxor        %%xmm5, %%xmm5     \n\t"
+        "pxor        %%xmm6, %%xmm6     \n\t"
+        "pxor        %%xmm7, %%xmm7     \n\t"
+        "1:                             \n\t"
+        "movdqu        (%1), %%xmm0     \n\t"
+        "movdqu        (%2), %%xmm1     \n\t"
+        "movdqu        (%3), %%xmm2     \n\t"
+        "psadbw      %%xmm0, %%xmm1     \n\t"
+        "psadbw      %%xmm0, %%xmm2     \n\t"
+        "paddd       %%xmm1, %%xmm4     \n\t"
+        "paddd       %%xmm2, %%xmm5     \n\t"
+        "movdqu        (%4), %%xmm1     \n\t"
+        "movdqu        (%5), %%xmm2     \n\t"
+        "psadbw      %%xmm0, %%xmm1     \n\t"
+        "psadbw      %%xmm0, %%xmm2     \n\t"
+        "paddd       %%xmm1, %%xmm6     \n\t"
+        "paddd       %%xmm2, %%xmm7     \n\t"
+        "add             %7, %1         \n\t"
+        "add             %7, %2         \n\t"
+        "add             %7, %3         \n\t"
+        "add             %7, %4         \n\t"
+        "add             %7, %5         \n\t"
+        "dec             %0             \n\t"
+        "jnz 1b                         \n\t"
+        "movhlps     %%xmm4, %%xmm0     \n\t"
+        "movhlps     %%xmm5, %%xmm1     \n\t"
+        "movhlps     %%xmm6, %%xmm2     \n\t"
+        "movhlps     %%xmm7, %%xmm3     \n\t"
+        "paddd       %%xmm0, %%xmm4     \n\t"
+        "paddd       %%xmm1, %%xmm5     \n\t"
+        "paddd       %%xmm2, %%xmm6     \n\t"
+        "paddd       %%xmm3, %%xmm7     \n\t"
+        "movd        %%xmm4,   (%6)     \n\t"
+        "movd        %%xmm5,  4(%6)     \n\t"
+        "movd        %%xmm6,  8(%6)     \n\t"
+        "movd        %%xmm7, 12(%6)     \n\t"
+        : "+r" (len), "+r" (blk1), "+r" (c0), "+r" (c1), "+r" (c2), "+r" (c3)
+        : "r" (scores), "r" (stride)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",
+                       "%xmm4", "%xmm5", "%xmm6", "%xmm7",)
+          "memory");
+}
+#endif /* ARCH_X86_64 */
+
 #endif /* HAVE_INLINE_ASM */
 
 av_cold void ff_me_cmp_init_x86(MECmpContext *c, AVCodecContext *avctx)
@@ -578,6 +632,11 @@ av_cold void ff_me_cmp_init_x86(MECmpContext *c, AVCodecContext *avctx)
         }
     }
 
+#if ARCH_X86_64
+    if (INLINE_SSE2(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SSE2SLOW))
+        c->sad_x4[0] = sad16_x4_sse2;
+#endif
+
 #endif /* HAVE_INLINE_ASM */
 
     if (EXTERNAL_MMX(cpu_flags)) {
@@ -32,6 +32,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
+#include "libavutil/registry.h"
 #include "libavutil/samplefmt.h"
 
 #include "audio.h"
@@ -512,6 +513,7 @@ int avfilter_process_command(AVFilterContext *filter, const char *cmd, const cha
 
 static AVFilter *first_filter;
 static AVFilter **last_filter = &first_filter;
+static FFRegistryIndex filter_name_index;
 
 #if !FF_API_NOCONST_GET_NAME
 const
@@ -519,13 +521,25 @@ const
 AVFilter *avfilter_get_by_name(const char *name)
 {
     const AVFilter *f = NULL;
+    const FFRegistryNode *node;
+    uint32_t key;
 
     if (!name)
         return NULL;
 
-    while ((f = avfilter_next(f)))
-        if (!strcmp(f->name, name))
+    if (filter_name_index.incomplete) {
+        while ((f = avfilter_next(f)))
+            if (!strcmp(f->name, name))
+                return (AVFilter *)f;
+        return NULL;
+    }
+
+    key = avpriv_registry_hash(name, SIZE_MAX);
+    for (node = ff_registry_bucket(&filter_name_index, key); node; node = node->next) {
+        f = node->item;
+        if (node->key == key && !strcmp(f->name, name))
             return (AVFilter *)f;
+    }
 
     return NULL;
 }
@@ -543,6 +557,9 @@ int avfilter_register(AVFilter *filter)
         f = &(*f)->next;
     last_filter = &filter->next;
 
+    avpriv_registry_add(&filter_name_index,
+                        avpriv_registry_hash(filter->name, SIZE_MAX), filter);
+
     return 0;
 }
 
@@ -1186,6 +1203,27 @@ static int ff_filter_frame_needs_framing(AVFilterLink *link, AVFrame *frame)
     return ret;
 }
 
+/**
+ * Send a frame over a fused link. The filters which only pass the frames on
+ * are skipped, as long as there is nothing for them to do on that frame.
+ */
+static int ff_filter_frame_fused(AVFilterLink *link, AVFrame *frame)
+{
+    AVFilterContext *dstctx = link->dst;
+
+    while (!link->dstpad->filter_frame && !link->status &&
+           !dstctx->enable_str && !dstctx->command_queue &&
+           (dstctx->outputs[0]->flags & FF_LINK_FLAG_FUSED)) {
+        link->frame_wanted_out = 0;
+        link->frame_count++;
+        ff_update_link_current_pts(link, frame->pts);
+        link   = dstctx->outputs[0];
+        dstctx = link->dst;
+    }
+    link->frame_wanted_out = 0;
+    return ff_filter_frame_framed(link, frame);
+}
+
 int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
 {
     FF_TPRINTF_START(NULL, filter_frame); ff_tlog_link(NULL, link, 1); ff_tlog(NULL, " "); ff_tlog_ref(NULL, frame, 1);
@@ -1220,6 +1258,9 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
         }
     }
 
+    if (link->flags & FF_LINK_FLAG_FUSED)
+        return ff_filter_frame_fused(link, frame);
+
     link->frame_wanted_out = 0;
     /* Go directly to actual filtering if possible */
     if (link->type == AVMEDIA_TYPE_AUDIO &&
@@ -1216,6 +1216,40 @@ static int graph_config_pointers(AVFilterGraph *graph,
     return 0;
 }
 
+/**
+ * Mark the links between filters with a single audio input and a single
+ * audio output, on which the frames can be sent straight to the next filter.
+ */
+static void graph_fuse_audio_chains(AVFilterGraph *graph, AVClass *log_ctx)
+{
+    int i, nb_fused = 0;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        AVFilterLink *link;
+
+        if (f->nb_inputs != 1)
+            continue;
+        link = f->inputs[0];
+        link->flags &= ~FF_LINK_FLAG_FUSED;
+
+        if (link->type         != AVMEDIA_TYPE_AUDIO ||
+            link->min_samples                         ||
+            f->nb_outputs      != 1                   ||
+            f->outputs[0]->type != AVMEDIA_TYPE_AUDIO ||
+            link->src->nb_inputs  != 1                ||
+            link->src->nb_outputs != 1)
+            continue;
+
+        link->flags |= FF_LINK_FLAG_FUSED;
+        nb_fused++;
+        av_log(log_ctx, AV_LOG_DEBUG, "Fused link between '%s' and '%s'\n",
+               link->src->name, f->name);
+    }
+    if (nb_fused)
+        av_log(log_ctx, AV_LOG_VERBOSE, "%d audio links fused\n", nb_fused);
+}
+
 static int graph_insert_fifos(AVFilterGraph *graph, AVClass *log_ctx)
 {
     AVFilterContext *f;
@@ -1268,6 +1302,7 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_config_pointers(graphctx, log_ctx)))
         return ret;
+    graph_fuse_audio_chains(graphctx, log_ctx);
 
     return 0;
 }
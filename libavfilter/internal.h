@@ -366,6 +366,15 @@ int ff_request_frame_to_filter(AVFilterLink *link);
  */
 int ff_filter_frame(AVFilterLink *link, AVFrame *frame);
 
+/**
+ * Flag for AVFilterLink.flags: the link is inside a linear audio chain, its
+ * properties were set by the format negotiation and no framing is done on
+ * it. ff_filter_frame() sends frames over such links without the checks,
+ * and skips the filters which only pass the frames on.
+ * Set by avfilter_graph_config().
+ */
+#define FF_LINK_FLAG_FUSED (1 << 0)
+
 /**
  * Allocate a new filter context and return it.
  *
@@ -26,128 +26,51 @@
 #include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
-#include "libavutil/thread.h"
+#include "libavutil/slicethread.h"
 
 #include "avfilter.h"
 #include "internal.h"
 #include "thread.h"
 
 typedef struct ThreadContext {
-    AVFilterGraph *graph;
-
-    int nb_threads;
-    pthread_t *workers;
-    avfilter_action_func *func;
+    AVSliceThread *slicethread;
 
     /* per-execute parameters */
     AVFilterContext *ctx;
+    avfilter_action_func *func;
     void *arg;
     int   *rets;
-    int nb_rets;
-    int nb_jobs;
-
-    pthread_cond_t last_job_cond;
-    pthread_cond_t current_job_cond;
-    pthread_mutex_t current_job_lock;
-    int current_job;
-    unsigned int current_execute;
-    int done;
 } ThreadContext;
 
-static void* attribute_align_arg worker(void *v)
+static void run_job(void *arg, int jobnr, int nb_jobs)
 {
-    ThreadContext *c = v;
-    int our_job      = c->nb_jobs;
-    int nb_threads   = c->nb_threads;
-    unsigned int last_execute = 0;
-    int self_id;
-
-    pthread_mutex_lock(&c->current_job_lock);
-    self_id = c->current_job++;
-    for (;;) {
-        while (our_job >= c->nb_jobs) {
-            if (c->current_job == nb_threads + c->nb_jobs)
-                pthread_cond_signal(&c->last_job_cond);
-
-            while (last_execute == c->current_execute && !c->done)
-                pthread_cond_wait(&c->current_job_cond, &c->current_job_lock);
-            last_execute = c->current_execute;
-            our_job = self_id;
-
-            if (c->done) {
-                pthread_mutex_unlock(&c->current_job_lock);
-                return NULL;
-            }
-        }
-        pthread_mutex_unlock(&c->current_job_lock);
-
-        c->rets[our_job % c->nb_rets] = c->func(c->ctx, c->arg, our_job, c->nb_jobs);
-
-        pthread_mutex_lock(&c->current_job_lock);
-        our_job = c->current_job++;
-    }
-}
-
-static void slice_thread_uninit(ThreadContext *c)
-{
-    int i;
-
-    pthread_mutex_lock(&c->current_job_lock);
-    c->done = 1;
-    pthread_cond_broadcast(&c->current_job_cond);
-    pthread_mutex_unlock(&c->current_job_lock);
-
-    for (i = 0; i < c->nb_threads; i++)
-         pthread_join(c->workers[i], NULL);
+    ThreadContext *c = arg;
+    int ret = c->func(c->ctx, c->arg, jobnr, nb_jobs);
 
-    pthread_mutex_destroy(&c->current_job_lock);
-    pthread_cond_destroy(&c->current_job_cond);
-    pthread_cond_destroy(&c->last_job_cond);
-    av_freep(&c->workers);
-}
-
-static void slice_thread_park_workers(ThreadContext *c)
-{
-    while (c->current_job != c->nb_threads + c->nb_jobs)
-        pthread_cond_wait(&c->last_job_cond, &c->current_job_lock);
-    pthread_mutex_unlock(&c->current_job_lock);
+    if (c->rets)
+        c->rets[jobnr] = ret;
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
                           void *arg, int *ret, int nb_jobs)
 {
     ThreadContext *c = ctx->graph->internal->thread;
-    int dummy_ret;
-
-    if (nb_jobs <= 0)
-        return 0;
-
-    pthread_mutex_lock(&c->current_job_lock);
-
-    c->current_job = c->nb_threads;
-    c->nb_jobs     = nb_jobs;
-    c->ctx         = ctx;
-    c->arg         = arg;
-    c->func        = func;
-    if (ret) {
-        c->rets    = ret;
-        c->nb_rets = nb_jobs;
-    } else {
-        c->rets    = &dummy_ret;
-        c->nb_rets = 1;
-    }
-    c->current_execute++;
 
-    pthread_cond_broadcast(&c->current_job_cond);
+    c->ctx  = ctx;
+    c->func = func;
+    c->arg  = arg;
+    c->rets = ret;
 
-    slice_thread_park_workers(c);
+    avpriv_slicethread_execute(c->slicethread, run_job, c, nb_jobs);
 
     return 0;
 }
 
-static int thread_init_internal(ThreadContext *c, int nb_threads)
+int ff_graph_thread_init(AVFilterGraph *graph)
 {
-    int i, ret;
+    ThreadContext *c;
+    int nb_threads = graph->nb_threads;
+    int ret;
 
     if (!nb_threads) {
         int nb_cpus = av_cpu_count();
@@ -158,56 +81,17 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
             nb_threads = 1;
     }
 
-    if (nb_threads <= 1)
-        return 1;
-
-    c->nb_threads = nb_threads;
-    c->workers = av_mallocz_array(sizeof(*c->workers), nb_threads);
-    if (!c->workers)
-        return AVERROR(ENOMEM);
-
-    c->current_job = 0;
-    c->nb_jobs     = 0;
-    c->done        = 0;
-
-    pthread_cond_init(&c->current_job_cond, NULL);
-    pthread_cond_init(&c->last_job_cond,    NULL);
-
-    pthread_mutex_init(&c->current_job_lock, NULL);
-    pthread_mutex_lock(&c->current_job_lock);
-    for (i = 0; i < nb_threads; i++) {
-        ret = pthread_create(&c->workers[i], NULL, worker, c);
-        if (ret) {
-           pthread_mutex_unlock(&c->current_job_lock);
-           c->nb_threads = i;
-           slice_thread_uninit(c);
-           return AVERROR(ret);
-        }
-    }
-
-    slice_thread_park_workers(c);
-
-    return c->nb_threads;
-}
-
-int ff_graph_thread_init(AVFilterGraph *graph)
-{
-    int ret;
-
-#if HAVE_W32THREADS
-    w32thread_init();
-#endif
-
-    if (graph->nb_threads == 1) {
+    if (nb_threads <= 1) {
         graph->thread_type = 0;
+        graph->nb_threads  = 1;
         return 0;
     }
 
-    graph->internal->thread = av_mallocz(sizeof(ThreadContext));
-    if (!graph->internal->thread)
+    graph->internal->thread = c = av_mallocz(sizeof(ThreadContext));
+    if (!c)
         return AVERROR(ENOMEM);
 
-    ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
+    ret = avpriv_slicethread_create(&c->slicethread, nb_threads);
     if (ret <= 1) {
         av_freep(&graph->internal->thread);
         graph->thread_type = 0;
@@ -223,7 +107,9 @@ int ff_graph_thread_init(AVFilterGraph *graph)
 
 void ff_graph_thread_free(AVFilterGraph *graph)
 {
-    if (graph->internal->thread)
-        slice_thread_uninit(graph->internal->thread);
+    ThreadContext *c = graph->internal->thread;
+
+    if (c)
+        avpriv_slicethread_free(&c->slicethread);
     av_freep(&graph->internal->thread);
 }
@@ -1,5 +1,5 @@
 /*
- * Input async protocol.
+ * Input/output async protocol.
  * Copyright (c) 2015 Zhang Rui <bbcallen@gmail.com>
  *
  * This file is part of FFmpeg.
@@ -44,6 +44,7 @@
 #define BUFFER_CAPACITY         (4 * 1024 * 1024)
 #define READ_BACK_CAPACITY      (4 * 1024 * 1024)
 #define SHORT_SEEK_THRESHOLD    (256 * 1024)
+#define WRITE_CHUNK_SIZE        (256 * 1024)
 
 typedef struct RingBuffer
 {
@@ -78,6 +79,9 @@ typedef struct Context {
 
     int             abort_request;
     AVIOInterruptCB interrupt_callback;
+
+    /* options */
+    int             write_buffer_size;
 } Context;
 
 static int ring_init(RingBuffer *ring, unsigned int capacity, int read_back_capacity)
@@ -173,6 +177,18 @@ static int wrapped_url_read(void *src, void *dst, int size)
     return ret;
 }
 
+static void wrapped_url_write(void *src, void *buf, int size)
+{
+    URLContext   *h   = src;
+    Context      *c   = h->priv_data;
+    int           ret;
+
+    if (c->inner_io_error < 0)
+        return;
+    ret = ffurl_write(c->inner, buf, size);
+    c->inner_io_error = ret < 0 ? ret : 0;
+}
+
 static void *async_buffer_task(void *arg)
 {
     URLContext   *h    = arg;
@@ -211,6 +227,31 @@ static void *async_buffer_task(void *arg)
             continue;
         }
 
+        if (h->flags & AVIO_FLAG_WRITE) {
+            int fifo_size = av_fifo_size(ring->fifo);
+            if (c->io_error || fifo_size <= 0) {
+                pthread_cond_signal(&c->cond_wakeup_main);
+                pthread_cond_wait(&c->cond_wakeup_background, &c->mutex);
+                pthread_mutex_unlock(&c->mutex);
+                continue;
+            }
+            pthread_mutex_unlock(&c->mutex);
+
+            /* The main thread only appends to the fifo, so the queued data
+             * can be written out without holding the lock. */
+            to_copy = FFMIN(WRITE_CHUNK_SIZE, fifo_size);
+            c->inner_io_error = 0;
+            av_fifo_generic_peek_at(ring->fifo, h, 0, to_copy, wrapped_url_write);
+
+            pthread_mutex_lock(&c->mutex);
+            av_fifo_drain(ring->fifo, to_copy);
+            if (c->inner_io_error < 0)
+                c->io_error = c->inner_io_error;
+            pthread_cond_signal(&c->cond_wakeup_main);
+            pthread_mutex_unlock(&c->mutex);
+            continue;
+        }
+
         fifo_space = ring_space(ring);
         if (c->io_eof_reached || fifo_space <= 0) {
             pthread_cond_signal(&c->cond_wakeup_main);
@@ -245,7 +286,15 @@ static int async_open(URLContext *h, const char *arg, int flags, AVDictionary **
 
     av_strstart(arg, "async:", &arg);
 
-    ret = ring_init(&c->ring, BUFFER_CAPACITY, READ_BACK_CAPACITY);
+    if ((flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_READ_WRITE) {
+        av_log(h, AV_LOG_ERROR, "async does not support read-write mode\n");
+        return AVERROR(ENOSYS);
+    }
+
+    if (flags & AVIO_FLAG_WRITE)
+        ret = ring_init(&c->ring, c->write_buffer_size, 0);
+    else
+        ret = ring_init(&c->ring, BUFFER_CAPACITY, READ_BACK_CAPACITY);
     if (ret < 0)
         goto fifo_fail;
 
@@ -300,12 +349,32 @@ fifo_fail:
     return ret;
 }
 
+/**
+ * Wait until the background thread has written out all queued data.
+ * Must be called with the mutex locked.
+ */
+static int async_wait_drained(URLContext *h)
+{
+    Context      *c    = h->priv_data;
+    RingBuffer   *ring = &c->ring;
+
+    while (av_fifo_size(ring->fifo) > 0 && !c->io_error) {
+        if (async_check_interrupt(h))
+            return AVERROR_EXIT;
+        pthread_cond_signal(&c->cond_wakeup_background);
+        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+    }
+    return c->io_error;
+}
+
 static int async_close(URLContext *h)
 {
     Context *c = h->priv_data;
-    int      ret;
+    int      ret, drain_ret = 0;
 
     pthread_mutex_lock(&c->mutex);
+    if (h->flags & AVIO_FLAG_WRITE)
+        drain_ret = async_wait_drained(h);
     c->abort_request = 1;
     pthread_cond_signal(&c->cond_wakeup_background);
     pthread_mutex_unlock(&c->mutex);
@@ -317,10 +386,10 @@ static int async_close(URLContext *h)
     pthread_cond_destroy(&c->cond_wakeup_background);
     pthread_cond_destroy(&c->cond_wakeup_main);
     pthread_mutex_destroy(&c->mutex);
-    ffurl_close(c->inner);
+    ret = ffurl_close(c->inner);
     ring_destroy(&c->ring);
 
-    return 0;
+    return drain_ret < 0 ? drain_ret : ret;
 }
 
 static int async_read_internal(URLContext *h, void *dest, int size, int read_complete,
@@ -375,10 +444,104 @@ static int async_read(URLContext *h, unsigned char *buf, int size)
     return async_read_internal(h, buf, size, 0, NULL);
 }
 
+static int async_write(URLContext *h, const unsigned char *buf, int size)
+{
+    Context      *c        = h->priv_data;
+    RingBuffer   *ring     = &c->ring;
+    int           to_write = size;
+    int           ret      = 0;
+
+    pthread_mutex_lock(&c->mutex);
+
+    while (to_write > 0) {
+        int to_copy;
+        if (async_check_interrupt(h)) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+        if (c->io_error) {
+            /* report the error of an earlier background write */
+            ret = c->io_error;
+            break;
+        }
+        to_copy = FFMIN(to_write, ring_space(ring));
+        if (to_copy > 0) {
+            ring_generic_write(ring, (void *)buf, to_copy, NULL);
+            buf            += to_copy;
+            to_write       -= to_copy;
+            c->logical_pos += to_copy;
+            c->logical_size = FFMAX(c->logical_size, c->logical_pos);
+            pthread_cond_signal(&c->cond_wakeup_background);
+            continue;
+        }
+        pthread_cond_signal(&c->cond_wakeup_background);
+        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+    }
+
+    pthread_cond_signal(&c->cond_wakeup_background);
+    pthread_mutex_unlock(&c->mutex);
+
+    return to_write < size ? size - to_write : ret;
+}
+
 static void fifo_do_not_copy_func(void* dest, void* src, int size) {
     // do not copy
 }
 
+/**
+ * Have the background thread seek the inner protocol and wait for the result.
+ * Must be called with the mutex locked.
+ */
+static int64_t async_seek_request(URLContext *h, int64_t pos, int whence)
+{
+    Context      *c    = h->priv_data;
+
+    c->seek_request   = 1;
+    c->seek_pos       = pos;
+    c->seek_whence    = whence;
+    c->seek_completed = 0;
+    c->seek_ret       = 0;
+
+    while (1) {
+        if (async_check_interrupt(h))
+            return AVERROR_EXIT;
+        if (c->seek_completed)
+            return c->seek_ret;
+        pthread_cond_signal(&c->cond_wakeup_background);
+        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
+    }
+}
+
+/**
+ * Seek in write mode: the queued data is written out first, so that header
+ * rewrites land after the data they refer to.
+ */
+static int64_t async_write_seek(URLContext *h, int64_t pos, int whence)
+{
+    Context      *c    = h->priv_data;
+    int64_t       ret;
+
+    if (whence == SEEK_CUR) {
+        pos   += c->logical_pos;
+        whence = SEEK_SET;
+    } else if (whence != SEEK_SET && whence != AVSEEK_SIZE) {
+        return AVERROR(EINVAL);
+    }
+
+    pthread_mutex_lock(&c->mutex);
+
+    ret = async_wait_drained(h);
+    if (ret >= 0) {
+        ret = async_seek_request(h, pos, whence);
+        if (ret >= 0 && whence != AVSEEK_SIZE)
+            c->logical_pos = ret;
+    }
+
+    pthread_mutex_unlock(&c->mutex);
+
+    return ret;
+}
+
 static int64_t async_seek(URLContext *h, int64_t pos, int whence)
 {
     Context      *c    = h->priv_data;
@@ -388,6 +551,9 @@ static int64_t async_seek(URLContext *h, int64_t pos, int whence)
     int fifo_size;
     int fifo_size_of_read_back;
 
+    if (h->flags & AVIO_FLAG_WRITE)
+        return async_write_seek(h, pos, whence);
+
     if (whence == AVSEEK_SIZE) {
         av_log(h, AV_LOG_TRACE, "async_seek: AVSEEK_SIZE: %"PRId64"\n", (int64_t)c->logical_size);
         return c->logical_size;
@@ -436,26 +602,9 @@ static int64_t async_seek(URLContext *h, int64_t pos, int whence)
 
     pthread_mutex_lock(&c->mutex);
 
-    c->seek_request   = 1;
-    c->seek_pos       = new_logical_pos;
-    c->seek_whence    = SEEK_SET;
-    c->seek_completed = 0;
-    c->seek_ret       = 0;
-
-    while (1) {
-        if (async_check_interrupt(h)) {
-            ret = AVERROR_EXIT;
-            break;
-        }
-        if (c->seek_completed) {
-            if (c->seek_ret >= 0)
-                c->logical_pos  = c->seek_ret;
-            ret = c->seek_ret;
-            break;
-        }
-        pthread_cond_signal(&c->cond_wakeup_background);
-        pthread_cond_wait(&c->cond_wakeup_main, &c->mutex);
-    }
+    ret = async_seek_request(h, new_logical_pos, SEEK_SET);
+    if (ret >= 0)
+        c->logical_pos = ret;
 
     pthread_mutex_unlock(&c->mutex);
 
@@ -463,13 +612,15 @@ static int64_t async_seek(URLContext *h, int64_t pos, int whence)
 }
 
 #define OFFSET(x) offsetof(Context, x)
-#define D AV_OPT_FLAG_DECODING_PARAM
+#define E AV_OPT_FLAG_ENCODING_PARAM
 
 static const AVOption options[] = {
+    { "write_buffer_size", "size of the write-behind buffer used for output",
+        OFFSET(write_buffer_size), AV_OPT_TYPE_INT, { .i64 = BUFFER_CAPACITY }, 4096, INT_MAX / 2, .flags = E },
     {NULL},
 };
 
-#undef D
+#undef E
 #undef OFFSET
 
 static const AVClass async_context_class = {
@@ -483,6 +634,7 @@ const URLProtocol ff_async_protocol = {
     .name                = "async",
     .url_open2           = async_open,
     .url_read            = async_read,
+    .url_write           = async_write,
     .url_seek            = async_seek,
     .url_close           = async_close,
     .priv_data_size      = sizeof(Context),
@@ -1906,6 +1906,32 @@ typedef struct AVFormatContext {
      * - decoding: set by user through AVOptions (NO direct access)
      */
     int max_streams;
+
+    /**
+     * Number of threads used to decode the streams in
+     * avformat_find_stream_info(), 0 for automatic.
+     * - encoding: unused
+     * - decoding: set by user through AVOptions (NO direct access)
+     */
+    int probe_threads;
+
+    /**
+     * Directory of the cache of probing results, NULL to disable it.
+     * Inputs found in the cache are neither probed for their format nor
+     * analyzed by avformat_find_stream_info().
+     * - encoding: unused
+     * - decoding: set by user through AVOptions (NO direct access)
+     */
+    char *probe_cache;
+
+    /**
+     * Path of a sidecar file holding the index of the keyframes of the
+     * input, NULL to disable it. The index is loaded before the first seek
+     * and written back when the input is closed, if it grew.
+     * - encoding: unused
+     * - decoding: set by user through AVOptions (NO direct access)
+     */
+    char *seek_index;
 } AVFormatContext;
 
 int av_format_get_probe_score(const AVFormatContext *s);
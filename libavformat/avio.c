@@ -434,6 +434,79 @@ int ffurl_write(URLContext *h, const unsigned char *buf, int size)
                                   h->prot->url_write);
 }
 
+int ffurl_writev(URLContext *h, const URLIOVec *iov, int iovcnt)
+{
+    URLIOVec vec[URL_MAX_IOV], *cur = vec;
+    int i, ret, len = 0, size = 0;
+    int fast_retries = 5;
+    int64_t wait_since = 0;
+
+    if (!(h->flags & AVIO_FLAG_WRITE))
+        return AVERROR(EIO);
+    if (iovcnt < 0 || iovcnt > URL_MAX_IOV)
+        return AVERROR(EINVAL);
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].size < 0 || iov[i].size > INT_MAX - size)
+            return AVERROR(EINVAL);
+        size += iov[i].size;
+    }
+    /* avoid sending too big packets */
+    if (h->max_packet_size && size > h->max_packet_size)
+        return AVERROR(EIO);
+
+    if (!h->prot->url_writev) {
+        for (i = 0; i < iovcnt; i++) {
+            ret = ffurl_write(h, iov[i].data, iov[i].size);
+            if (ret < 0)
+                return ret;
+            len += ret;
+            if (ret < iov[i].size)
+                break;
+        }
+        return len;
+    }
+
+    memcpy(vec, iov, iovcnt * sizeof(*vec));
+    while (len < size) {
+        if (ff_check_interrupt(&h->interrupt_callback))
+            return AVERROR_EXIT;
+        ret = h->prot->url_writev(h, cur, iovcnt);
+        if (ret == AVERROR(EINTR))
+            continue;
+        if (h->flags & AVIO_FLAG_NONBLOCK)
+            return len ? len : ret;
+        if (ret == AVERROR(EAGAIN)) {
+            if (fast_retries) {
+                fast_retries--;
+            } else {
+                if (h->rw_timeout) {
+                    if (!wait_since)
+                        wait_since = av_gettime_relative();
+                    else if (av_gettime_relative() > wait_since + h->rw_timeout)
+                        return AVERROR(EIO);
+                }
+                av_usleep(1000);
+            }
+            continue;
+        } else if (ret < 1)
+            return (ret < 0 && ret != AVERROR_EOF) ? ret : len;
+        fast_retries = FFMAX(fast_retries, 2);
+        wait_since = 0;
+        len += ret;
+        /* drop the fully written elements and advance into the next one */
+        while (iovcnt && ret >= cur->size) {
+            ret -= cur->size;
+            cur++;
+            iovcnt--;
+        }
+        if (iovcnt) {
+            cur->data += ret;
+            cur->size -= ret;
+        }
+    }
+    return len;
+}
+
 int64_t ffurl_seek(URLContext *h, int64_t pos, int whence)
 {
     int64_t ret;
@@ -63,6 +63,14 @@ int ffio_read_partial(AVIOContext *s, unsigned char *buf, int size);
 
 void ffio_fill(AVIOContext *s, int b, int count);
 
+/**
+ * Write iovcnt buffers to s, in order, e.g. a packet header and its payload.
+ * If s writes to a URLContext and the data does not fit in the IO buffer,
+ * the buffered bytes and the given buffers are handed to the protocol in
+ * one vectored write without being copied into the IO buffer.
+ */
+void ffio_writev(AVIOContext *s, const URLIOVec *iov, int iovcnt);
+
 static av_always_inline void ffio_wfourcc(AVIOContext *pb, const uint8_t *s)
 {
     avio_wl32(pb, MKTAG(s[0], s[1], s[2], s[3]));
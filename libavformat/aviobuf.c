@@ -77,6 +77,7 @@ const AVClass ff_avio_class = {
 
 static void fill_buffer(AVIOContext *s);
 static int url_resetbuf(AVIOContext *s, int flags);
+static int io_write_packet(void *opaque, uint8_t *buf, int buf_size);
 
 int ffio_init_context(AVIOContext *s,
                   unsigned char *buffer,
@@ -179,6 +180,53 @@ static void flush_buffer(AVIOContext *s)
         s->buf_end = s->buffer;
 }
 
+/**
+ * Return whether writes of the given size should bypass the IO buffer and be
+ * passed to the underlying URLContext directly.
+ */
+static int can_write_unbuffered(AVIOContext *s, int64_t size)
+{
+    return s->write_packet == io_write_packet && !s->write_data_type &&
+           !s->update_checksum && !s->max_packet_size &&
+           size >= s->buffer_size;
+}
+
+/**
+ * Write the buffered data followed by the iovcnt given buffers to the
+ * URLContext in a single vectored write, leaving the buffer empty.
+ */
+static void writeout_iov(AVIOContext *s, const URLIOVec *iov, int iovcnt)
+{
+    AVIOInternal *internal = s->opaque;
+    URLIOVec vec[URL_MAX_IOV];
+    int i, n = 0, len = 0;
+
+    av_assert0(iovcnt < URL_MAX_IOV);
+    if (s->buf_ptr > s->buffer) {
+        vec[n].data = s->buffer;
+        vec[n].size = s->buf_ptr - s->buffer;
+        len += vec[n++].size;
+    }
+    for (i = 0; i < iovcnt; i++) {
+        vec[n++] = iov[i];
+        len     += iov[i].size;
+    }
+
+    if (!s->error) {
+        int ret = ffurl_writev(internal->h, vec, n);
+        if (ret < 0)
+            s->error = ret;
+    }
+    if (s->current_type == AVIO_DATA_MARKER_SYNC_POINT ||
+        s->current_type == AVIO_DATA_MARKER_BOUNDARY_POINT) {
+        s->current_type = AVIO_DATA_MARKER_UNKNOWN;
+    }
+    s->last_time = AV_NOPTS_VALUE;
+    s->writeout_count ++;
+    s->pos += len;
+    s->buf_ptr = s->buffer;
+}
+
 void avio_w8(AVIOContext *s, int b)
 {
     av_assert2(b>=-128 && b<=255);
@@ -208,6 +256,11 @@ void avio_write(AVIOContext *s, const unsigned char *buf, int size)
         writeout(s, buf, size);
         return;
     }
+    if (can_write_unbuffered(s, size)) {
+        URLIOVec iov = { buf, size };
+        writeout_iov(s, &iov, 1);
+        return;
+    }
     while (size > 0) {
         int len = FFMIN(s->buf_end - s->buf_ptr, size);
         memcpy(s->buf_ptr, buf, len);
@@ -221,6 +274,22 @@ void avio_write(AVIOContext *s, const unsigned char *buf, int size)
     }
 }
 
+void ffio_writev(AVIOContext *s, const URLIOVec *iov, int iovcnt)
+{
+    int64_t size = 0;
+    int i;
+
+    for (i = 0; i < iovcnt; i++)
+        size += iov[i].size;
+    if (!s->direct && iovcnt < URL_MAX_IOV && size <= INT_MAX &&
+        can_write_unbuffered(s, size)) {
+        writeout_iov(s, iov, iovcnt);
+        return;
+    }
+    for (i = 0; i < iovcnt; i++)
+        avio_write(s, iov[i].data, iov[i].size);
+}
+
 void avio_flush(AVIOContext *s)
 {
     flush_buffer(s);
@@ -23,6 +23,7 @@
 #include "libavutil/avstring.h"
 #include "libavutil/bprint.h"
 #include "libavutil/opt.h"
+#include "libavutil/registry.h"
 
 #include "avio_internal.h"
 #include "avformat.h"
@@ -42,6 +43,9 @@ static AVOutputFormat *first_oformat = NULL;
 static AVInputFormat **last_iformat = &first_iformat;
 static AVOutputFormat **last_oformat = &first_oformat;
 
+/** registered input formats, indexed by each of their names */
+static FFRegistryIndex iformat_name_index;
+
 AVInputFormat *av_iformat_next(const AVInputFormat *f)
 {
     if (f)
@@ -61,13 +65,30 @@ AVOutputFormat *av_oformat_next(const AVOutputFormat *f)
 void av_register_input_format(AVInputFormat *format)
 {
     AVInputFormat **p = last_iformat;
+    const char *name;
+    int added = 0;
 
     // Note, format could be added after the first 2 checks but that implies that *p is no longer NULL
-    while(p != &format->next && !format->next && avpriv_atomic_ptr_cas((void * volatile *)p, NULL, format))
+    while (p != &format->next && !format->next) {
+        if (!avpriv_atomic_ptr_cas((void * volatile *)p, NULL, format)) {
+            added = 1;
+            break;
+        }
         p = &(*p)->next;
+    }
 
     if (!format->next)
         last_iformat = &format->next;
+
+    if (!added)
+        return;
+
+    for (name = format->name; *name; ) {
+        size_t len = strcspn(name, ",");
+        avpriv_registry_add(&iformat_name_index,
+                            avpriv_registry_hash(name, len), format);
+        name += len + (name[len] == ',');
+    }
 }
 
 void av_register_output_format(AVOutputFormat *format)
@@ -164,9 +185,27 @@ enum AVCodecID av_guess_codec(AVOutputFormat *fmt, const char *short_name,
 AVInputFormat *av_find_input_format(const char *short_name)
 {
     AVInputFormat *fmt = NULL;
-    while ((fmt = av_iformat_next(fmt)))
-        if (av_match_name(short_name, fmt->name))
+    const FFRegistryNode *node;
+    uint32_t key;
+
+    if (!short_name)
+        return NULL;
+
+    if (iformat_name_index.incomplete || strchr(short_name, ',')) {
+        while ((fmt = av_iformat_next(fmt)))
+            if (av_match_name(short_name, fmt->name))
+                return fmt;
+        return NULL;
+    }
+
+    /* the index holds the formats in registration order, so the first match
+     * is the one the list walk would return */
+    key = avpriv_registry_hash(short_name, SIZE_MAX);
+    for (node = ff_registry_bucket(&iformat_name_index, key); node; node = node->next) {
+        fmt = (AVInputFormat *)node->item;
+        if (node->key == key && av_match_name(short_name, fmt->name))
             return fmt;
+    }
     return NULL;
 }
 
@@ -1503,7 +1503,8 @@ static int save_avio_options(AVFormatContext *s)
 {
     HLSContext *c = s->priv_data;
     static const char *opts[] = {
-        "headers", "http_proxy", "user_agent", "user-agent", "cookies", NULL };
+        "headers", "http_proxy", "user_agent", "user-agent", "cookies",
+        "connection_pool", NULL };
     const char **opt = opts;
     uint8_t *buf;
     int ret = 0;
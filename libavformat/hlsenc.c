@@ -129,6 +129,7 @@ typedef struct HLSContext {
     AVDictionary *vtt_format_options;
 
     char *method;
+    int http_persistent;
 
     double initial_prog_date_time;
 } HLSContext;
@@ -488,6 +489,8 @@ static void set_http_options(AVDictionary **options, HLSContext *c)
 {
     if (c->method)
         av_dict_set(options, "method", c->method, 0);
+    if (c->http_persistent)
+        av_dict_set(options, "connection_pool", "1", 0);
 }
 
 static int hls_window(AVFormatContext *s, int last)
@@ -1108,6 +1111,7 @@ static const AVOption options[] = {
     {"event", "EVENT playlist", 0, AV_OPT_TYPE_CONST, {.i64 = PLAYLIST_TYPE_EVENT }, INT_MIN, INT_MAX, E, "pl_type" },
     {"vod", "VOD playlist", 0, AV_OPT_TYPE_CONST, {.i64 = PLAYLIST_TYPE_VOD }, INT_MIN, INT_MAX, E, "pl_type" },
     {"method", "set the HTTP method", OFFSET(method), AV_OPT_TYPE_STRING, {.str = NULL},  0, 0,    E},
+    {"http_persistent", "reuse HTTP connections across segment uploads", OFFSET(http_persistent), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, E },
 
     { NULL },
 };
@@ -28,6 +28,7 @@
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/opt.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 
 #include "avformat.h"
@@ -46,6 +47,7 @@
  * path names). */
 #define BUFFER_SIZE   MAX_URL_SIZE
 #define MAX_REDIRECTS 8
+#define POOL_SIZE     32
 #define HTTP_SINGLE   1
 #define HTTP_MUTLI    2
 typedef enum {
@@ -120,8 +122,25 @@ typedef struct HTTPContext {
     int is_multi_client;
     HandshakeState handshake_step;
     int is_connected_server;
+    /* A flag which indicates if connections are shared through the pool. */
+    int connection_pool;
+    int pool_idle_timeout;
+    /* Pool key (lower protocol URL) of s->hd, empty if it may not be pooled. */
+    char pool_key[1024];
 } HTTPContext;
 
+/* Process-wide pool of idle persistent connections, keyed by the URL of the
+ * lower protocol (e.g. tcp://host:port). */
+typedef struct HTTPPoolEntry {
+    char key[1024];
+    URLContext *hd;
+    int64_t expires;
+} HTTPPoolEntry;
+
+static HTTPPoolEntry http_pool[POOL_SIZE];
+static AVMutex http_pool_mutex;
+static AVOnce http_pool_init_once = AV_ONCE_INIT;
+
 #define OFFSET(x) offsetof(HTTPContext, x)
 #define D AV_OPT_FLAG_DECODING_PARAM
 #define E AV_OPT_FLAG_ENCODING_PARAM
@@ -160,6 +179,8 @@ static const AVOption options[] = {
     { "listen", "listen on HTTP", OFFSET(listen), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 2, D | E },
     { "resource", "The resource requested by a client", OFFSET(resource), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
     { "reply_code", "The http status code to return to a client", OFFSET(reply_code), AV_OPT_TYPE_INT, { .i64 = 200}, INT_MIN, 599, E},
+    { "connection_pool", "share persistent connections with other HTTP contexts", OFFSET(connection_pool), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, D | E },
+    { "pool_idle_timeout", "time in seconds an idle pooled connection is kept open", OFFSET(pool_idle_timeout), AV_OPT_TYPE_INT, { .i64 = 30 }, 0, INT_MAX / 1000000, D | E },
     { NULL }
 };
 
@@ -178,6 +199,103 @@ void ff_http_init_auth_state(URLContext *dest, const URLContext *src)
            sizeof(HTTPAuthState));
 }
 
+static void http_pool_init(void)
+{
+    ff_mutex_init(&http_pool_mutex, NULL);
+}
+
+/**
+ * Check that an idle connection has not been closed by the server: any
+ * pending data or EOF on it means it cannot be used for a new request.
+ */
+static int http_pool_conn_alive(URLContext *hd)
+{
+    struct pollfd p = { ffurl_get_file_handle(hd), POLLIN, 0 };
+
+    if (p.fd < 0)
+        return 0;
+    return poll(&p, 1, 0) == 0;
+}
+
+/**
+ * Take an idle connection to key out of the pool, closing the expired and
+ * dead connections found on the way.
+ *
+ * @return the connection, or NULL if none is available
+ */
+static URLContext *http_pool_get(URLContext *h, const char *key)
+{
+    URLContext *expired[POOL_SIZE], *hd = NULL;
+    int64_t now = av_gettime_relative();
+    int i, nb_expired = 0;
+
+    ff_thread_once(&http_pool_init_once, http_pool_init);
+    ff_mutex_lock(&http_pool_mutex);
+    for (i = 0; i < POOL_SIZE; i++) {
+        HTTPPoolEntry *e = &http_pool[i];
+        if (!e->hd)
+            continue;
+        if (e->expires < now) {
+            expired[nb_expired++] = e->hd;
+            e->hd = NULL;
+        } else if (!hd && !strcmp(e->key, key)) {
+            hd    = e->hd;
+            e->hd = NULL;
+        }
+    }
+    ff_mutex_unlock(&http_pool_mutex);
+
+    for (i = 0; i < nb_expired; i++)
+        ffurl_close(expired[i]);
+
+    if (hd && !http_pool_conn_alive(hd)) {
+        av_log(h, AV_LOG_DEBUG, "pooled connection to %s was closed\n", key);
+        ffurl_close(hd);
+        return http_pool_get(h, key);
+    }
+    if (hd) {
+        av_log(h, AV_LOG_DEBUG, "reusing pooled connection to %s\n", key);
+        hd->interrupt_callback = h->interrupt_callback;
+    }
+    return hd;
+}
+
+/**
+ * Put an idle connection into the pool, evicting the one closest to
+ * expiration if the pool is full.
+ */
+static void http_pool_put(URLContext *hd, const char *key, int idle_timeout)
+{
+    URLContext *evicted = NULL;
+    HTTPPoolEntry *e = &http_pool[0];
+    int i;
+
+    ff_thread_once(&http_pool_init_once, http_pool_init);
+    ff_mutex_lock(&http_pool_mutex);
+    for (i = 0; i < POOL_SIZE; i++) {
+        if (!http_pool[i].hd) {
+            e = &http_pool[i];
+            break;
+        }
+        if (http_pool[i].expires < e->expires)
+            e = &http_pool[i];
+    }
+    evicted    = e->hd;
+    e->hd      = hd;
+    e->expires = av_gettime_relative() + idle_timeout * 1000000LL;
+    av_strlcpy(e->key, key, sizeof(e->key));
+    ff_mutex_unlock(&http_pool_mutex);
+
+    ffurl_close(evicted);
+}
+
+/* Errors on a pooled connection that mean the server dropped it meanwhile. */
+static int http_pool_conn_error(int err)
+{
+    return err == AVERROR_EOF || err == AVERROR(EIO) ||
+           err == AVERROR(EPIPE) || err == AVERROR(ECONNRESET);
+}
+
 static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 {
     const char *path, *proxy_path, *lower_proto = "tcp", *local_path;
@@ -185,8 +303,9 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
     char auth[1024], proxyauth[1024] = "";
     char path1[MAX_URL_SIZE];
     char buf[1024], urlbuf[MAX_URL_SIZE];
-    int port, use_proxy, err, location_changed = 0;
+    int port, use_proxy, err, location_changed = 0, reused = 0;
     HTTPContext *s = h->priv_data;
+    uint64_t off = s->off;
 
     av_url_split(proto, sizeof(proto), auth, sizeof(auth),
                  hostname, sizeof(hostname), &port,
@@ -223,6 +342,18 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 
     ff_url_join(buf, sizeof(buf), lower_proto, NULL, hostname, port, NULL);
 
+    if (!s->hd) {
+        /* only plain tcp connections are pooled, since the interrupt
+         * callback of nested protocols cannot be updated on reuse */
+        if (s->connection_pool && !strcmp(lower_proto, "tcp")) {
+            av_strlcpy(s->pool_key, buf, sizeof(s->pool_key));
+            s->hd  = http_pool_get(h, buf);
+            reused = !!s->hd;
+        } else {
+            s->pool_key[0] = '\0';
+        }
+    }
+
     if (!s->hd) {
         err = ffurl_open_whitelist(&s->hd, buf, AVIO_FLAG_READ_WRITE,
                                    &h->interrupt_callback, options,
@@ -233,6 +364,12 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 
     err = http_connect(h, path, local_path, hoststr,
                        auth, proxyauth, &location_changed);
+    if (err < 0 && reused && http_pool_conn_error(err)) {
+        /* the server closed the idle connection, retry on a new one */
+        ffurl_closep(&s->hd);
+        s->off = off;
+        return http_open_cnx_internal(h, options);
+    }
     if (err < 0)
         return err;
 
@@ -1078,7 +1215,7 @@ static int http_connect(URLContext *h, const char *path, const char *local_path,
                            "Expect: 100-continue\r\n");
 
     if (!has_header(s->headers, "\r\nConnection: ")) {
-        if (s->multiple_requests)
+        if (s->multiple_requests || s->connection_pool)
             len += av_strlcpy(headers + len, "Connection: keep-alive\r\n",
                               sizeof(headers) - len);
         else
@@ -1455,6 +1592,43 @@ static int http_shutdown(URLContext *h, int flags)
     return ret;
 }
 
+/**
+ * Return whether the response on s->hd has been entirely consumed, so that
+ * the connection can be used for another request.
+ */
+static int http_conn_reusable(HTTPContext *s)
+{
+    uint64_t target_end = s->end_off ? s->end_off : s->filesize;
+
+    return s->connection_pool && s->pool_key[0] && !s->willclose &&
+           !s->listen && s->end_header &&
+           target_end != UINT64_MAX && s->off >= target_end &&
+           s->buf_ptr == s->buf_end;
+}
+
+/**
+ * Read the reply to an upload and skip its body, so that the connection
+ * can be returned to the pool.
+ */
+static int http_finish_upload(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    uint8_t buf[1024];
+    int ret, new_location;
+
+    if ((ret = http_read_header(h, &new_location)) < 0)
+        return ret;
+    if (s->http_code == 204 && s->filesize == UINT64_MAX)
+        s->filesize = 0;
+    /* without a known length the body cannot be skipped, and the
+     * connection will not be pooled */
+    if (s->chunksize != UINT64_MAX || s->filesize == UINT64_MAX)
+        return 0;
+    while ((ret = http_buf_read(h, buf, sizeof(buf))) > 0)
+        ;
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
 static int http_close(URLContext *h)
 {
     int ret = 0;
@@ -1469,6 +1643,14 @@ static int http_close(URLContext *h)
         /* Close the write direction by sending the end of chunked encoding. */
         ret = http_shutdown(h, h->flags);
 
+    if (s->hd && s->connection_pool && s->pool_key[0] && ret >= 0 &&
+        (h->flags & AVIO_FLAG_WRITE) && !s->end_header && !s->listen)
+        ret = http_finish_upload(h);
+
+    if (s->hd && ret >= 0 && http_conn_reusable(s)) {
+        http_pool_put(s->hd, s->pool_key, s->pool_idle_timeout);
+        s->hd = NULL;
+    }
     if (s->hd)
         ffurl_closep(&s->hd);
     av_dict_free(&s->chained_options);
@@ -140,6 +140,41 @@ struct AVFormatInternal {
      * Whether or not avformat_init_output fully initialized streams
      */
     int streams_initialized;
+
+    /**
+     * Fingerprint of the input for the probe cache, empty if none.
+     */
+    char probe_cache_key[41];
+
+    /**
+     * Probe cache entry found for the input, applied and freed by
+     * avformat_find_stream_info().
+     */
+    struct ProbeCacheEntry *probe_cache_entry;
+
+    /**
+     * SHA-1 of the ids, types and codecs of the streams created by the
+     * demuxer, set by ff_probe_cache_apply().
+     */
+    uint8_t probe_cache_layout[20];
+
+    /**
+     * State of the sidecar seek index: 0 if not looked up yet, 1 if its
+     * entries were loaded, -1 if there is none or it does not match.
+     */
+    int seek_index_state;
+
+    /**
+     * Number of index entries loaded from the seek index, the file is only
+     * rewritten if the streams have more.
+     */
+    int64_t seek_index_nb_entries;
+
+    /**
+     * Set while ff_seek_frame_binary() reads from arbitrary positions, where
+     * the key flags of the packets cannot be trusted to build an index.
+     */
+    int seek_index_searching;
 };
 
 struct AVStreamInternal {
@@ -4634,7 +4634,10 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
     for (i = 0; i < mov->nb_streams; i++) {
         MOVTrack *track = &mov->tracks[i];
         int buf_size, write_moof = 1, moof_tracks = -1;
-        uint8_t *buf;
+        uint8_t *buf = NULL;
+        uint8_t mdat_header[8];
+        URLIOVec iov[2];
+        int iovcnt = 0;
         int64_t duration = 0;
 
         if (track->entry)
@@ -4655,8 +4658,12 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
             mov_write_moof_tag(s->pb, mov, moof_tracks, mdat_size);
             mov->fragments++;
 
-            avio_wb32(s->pb, mdat_size + 8);
-            ffio_wfourcc(s->pb, "mdat");
+            /* written together with the payload, which can then be passed
+             * to the protocol without going through the IO buffer */
+            AV_WB32(mdat_header, mdat_size + 8);
+            AV_WL32(mdat_header + 4, MKTAG('m', 'd', 'a', 't'));
+            iov[iovcnt].data   = mdat_header;
+            iov[iovcnt++].size = sizeof(mdat_header);
         }
 
         if (track->entry)
@@ -4665,18 +4672,22 @@ static int mov_flush_fragment(AVFormatContext *s, int force)
         track->entries_flushed = 0;
         track->end_reliable = 0;
         if (!mov->frag_interleave) {
-            if (!track->mdat_buf)
-                continue;
-            buf_size = avio_close_dyn_buf(track->mdat_buf, &buf);
-            track->mdat_buf = NULL;
+            if (track->mdat_buf) {
+                buf_size = avio_close_dyn_buf(track->mdat_buf, &buf);
+                track->mdat_buf = NULL;
+            }
         } else {
-            if (!mov->mdat_buf)
-                continue;
-            buf_size = avio_close_dyn_buf(mov->mdat_buf, &buf);
-            mov->mdat_buf = NULL;
+            if (mov->mdat_buf) {
+                buf_size = avio_close_dyn_buf(mov->mdat_buf, &buf);
+                mov->mdat_buf = NULL;
+            }
+        }
+        if (buf) {
+            iov[iovcnt].data   = buf;
+            iov[iovcnt++].size = buf_size;
         }
 
-        avio_write(s->pb, buf, buf_size);
+        ffio_writev(s->pb, iov, iovcnt);
         av_free(buf);
     }
 
@@ -6028,6 +6039,13 @@ static int shift_data(AVFormatContext *s)
      * writing, so we re-open the same output, but for reading. It also avoids
      * a read/seek/write/seek back and forth. */
     avio_flush(s->pb);
+
+    /* mark the end of the shift to up to the last data we wrote, and get ready
+     * for writing; seeking before re-opening also makes write-behind
+     * protocols (async) commit the queued data */
+    pos_end = avio_tell(s->pb);
+    avio_seek(s->pb, mov->reserved_header_pos + moov_size, SEEK_SET);
+
     ret = s->io_open(s, &read_pb, s->filename, AVIO_FLAG_READ, NULL);
     if (ret < 0) {
         av_log(s, AV_LOG_ERROR, "Unable to re-open %s output file for "
@@ -6035,11 +6053,6 @@ static int shift_data(AVFormatContext *s)
         goto end;
     }
 
-    /* mark the end of the shift to up to the last data we wrote, and get ready
-     * for writing */
-    pos_end = avio_tell(s->pb);
-    avio_seek(s->pb, mov->reserved_header_pos + moov_size, SEEK_SET);
-
     /* start reading at where the new moov will be placed */
     avio_seek(read_pb, mov->reserved_header_pos, SEEK_SET);
     pos = avio_tell(read_pb);
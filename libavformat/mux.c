@@ -968,6 +968,7 @@ int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
 {
     int ret;
     AVPacketList **next_point, *this_pktl;
+    AVPacket *in   = pkt;
     AVStream *st   = s->streams[pkt->stream_index];
     int chunked    = s->max_chunk_size || s->max_chunk_duration;
 
@@ -981,12 +982,17 @@ int ff_interleave_add_packet(AVFormatContext *s, AVPacket *pkt,
         pkt->buf = NULL;
         pkt->side_data = NULL;
         pkt->side_data_elems = 0;
+    } else if (pkt->buf) {
+        /* the packet is unreferenced below, take its data and side data
+         * over instead of copying them */
+        av_packet_move_ref(&this_pktl->pkt, pkt);
     } else {
         if ((ret = av_packet_ref(&this_pktl->pkt, pkt)) < 0) {
             av_free(this_pktl);
             return ret;
         }
     }
+    pkt = &this_pktl->pkt;
 
     if (s->streams[pkt->stream_index]->last_in_packet_buffer) {
         next_point = &(st->last_in_packet_buffer->next);
@@ -1036,7 +1042,7 @@ next_non_null:
     s->streams[pkt->stream_index]->last_in_packet_buffer =
         *next_point                                      = this_pktl;
 
-    av_packet_unref(pkt);
+    av_packet_unref(in);
 
     return 0;
 }
@@ -106,6 +106,9 @@ static const AVOption avformat_options[] = {
 {"protocol_whitelist", "List of protocols that are allowed to be used", OFFSET(protocol_whitelist), AV_OPT_TYPE_STRING, { .str = NULL },  CHAR_MIN, CHAR_MAX, D },
 {"protocol_blacklist", "List of protocols that are not allowed to be used", OFFSET(protocol_blacklist), AV_OPT_TYPE_STRING, { .str = NULL },  CHAR_MIN, CHAR_MAX, D },
 {"max_streams", "maximum number of streams", OFFSET(max_streams), AV_OPT_TYPE_INT, { .i64 = 1000 }, 0, INT_MAX, D },
+{"probe_threads", "number of threads used to decode streams while probing", OFFSET(probe_threads), AV_OPT_TYPE_INT, { .i64 = 1 }, 0, INT_MAX, D },
+{"probe_cache", "directory of the cache of probing results", OFFSET(probe_cache), AV_OPT_TYPE_STRING, { .str = NULL }, CHAR_MIN, CHAR_MAX, D },
+{"seek_index", "sidecar file of the keyframe index", OFFSET(seek_index), AV_OPT_TYPE_STRING, { .str = NULL }, CHAR_MIN, CHAR_MAX, D },
 {NULL},
 };
 
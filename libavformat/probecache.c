@@ -0,0 +1,554 @@
+/*
+ * Persistent cache of probing results
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Cache of the results of format probing and avformat_find_stream_info().
+ *
+ * Each input is identified by a fingerprint made of its size, modification
+ * time and the hash of its first and last PROBE_CACHE_HASH_SIZE bytes, as
+ * well as the options which influence probing. Every entry is a file named
+ * after the fingerprint in the cache directory. An entry is only used if the
+ * demuxer creates the same streams as when it was stored, with the same
+ * codecs.
+ */
+
+#include <sys/stat.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/opt.h"
+#include "libavutil/random_seed.h"
+#include "libavutil/sha.h"
+#include "avformat.h"
+#include "avio_internal.h"
+#include "internal.h"
+#include "os_support.h"
+#include "probecache.h"
+#include "version.h"
+
+#define PROBE_CACHE_HASH_SIZE   (64 * 1024)
+#define PROBE_CACHE_MAGIC       MKBETAG('F', 'F', 'P', 'C')
+#define PROBE_CACHE_VERSION     2
+#define PROBE_CACHE_LAYOUT_SIZE 20
+
+typedef struct ProbeCacheStream {
+    int id;
+    int disposition;
+    int64_t start_time;
+    int64_t duration;
+    AVRational avg_frame_rate;
+    AVRational r_frame_rate;
+    AVRational sample_aspect_ratio;
+    AVRational codec_time_base;
+    int ticks_per_frame;
+    int codec_info_nb_frames;
+    AVCodecParameters *par;
+} ProbeCacheStream;
+
+typedef struct ProbeCacheEntry {
+    char format_name[64];
+    uint8_t layout[PROBE_CACHE_LAYOUT_SIZE];
+    int probe_score;
+    int64_t start_time;
+    int64_t duration;
+    int64_t bit_rate;
+    int duration_estimation_method;
+    int nb_streams;
+    ProbeCacheStream *streams;
+} ProbeCacheEntry;
+
+static void entry_free(ProbeCacheEntry **pentry)
+{
+    ProbeCacheEntry *entry = *pentry;
+    int i;
+
+    if (!entry)
+        return;
+    for (i = 0; i < entry->nb_streams; i++)
+        avcodec_parameters_free(&entry->streams[i].par);
+    av_freep(&entry->streams);
+    av_freep(pentry);
+}
+
+static int hash_range(AVIOContext *pb, struct AVSHA *sha, uint8_t *buf,
+                      int64_t pos, int size)
+{
+    int ret;
+
+    if ((ret = avio_seek(pb, pos, SEEK_SET)) < 0)
+        return ret;
+    ret = avio_read(pb, buf, size);
+    if (ret != size)
+        return ret < 0 ? ret : AVERROR_EOF;
+    av_sha_update(sha, buf, size);
+    return 0;
+}
+
+static void hash_int(struct AVSHA *sha, int64_t v)
+{
+    uint8_t buf[8];
+
+    AV_WB64(buf, v);
+    av_sha_update(sha, buf, sizeof(buf));
+}
+
+int ff_probe_cache_hash_input(AVFormatContext *s, struct AVSHA *sha)
+{
+    AVIOContext *pb = s->pb;
+    const char *path = s->filename;
+    struct stat st;
+    uint8_t *buf;
+    int64_t size, pos = avio_tell(pb);
+    const char *proto = avio_find_protocol_name(s->filename);
+    int64_t mtime = 0;
+    int ret;
+
+    if (!pb->seekable || (size = avio_size(pb)) <= 0)
+        return AVERROR(ENOSYS);
+
+    av_strstart(path, "file:", &path);
+    if (proto && !strcmp(proto, "file") && !stat(path, &st))
+        mtime = st.st_mtime;
+
+    if (!(buf = av_malloc(PROBE_CACHE_HASH_SIZE)))
+        return AVERROR(ENOMEM);
+
+    hash_int(sha, size);
+    hash_int(sha, mtime);
+
+    ret = hash_range(pb, sha, buf, 0, FFMIN(size, PROBE_CACHE_HASH_SIZE));
+    if (ret >= 0 && size > PROBE_CACHE_HASH_SIZE)
+        ret = hash_range(pb, sha, buf,
+                         FFMAX(size - PROBE_CACHE_HASH_SIZE, PROBE_CACHE_HASH_SIZE),
+                         FFMIN(size - PROBE_CACHE_HASH_SIZE, PROBE_CACHE_HASH_SIZE));
+    if (avio_seek(pb, pos, SEEK_SET) < 0 && ret >= 0)
+        ret = AVERROR(EIO);
+
+    av_free(buf);
+    return ret;
+}
+
+static void hash_str(struct AVSHA *sha, const char *str)
+{
+    av_sha_update(sha, str, strlen(str) + 1);
+}
+
+static int compute_key(AVFormatContext *s, AVDictionary *options, char *key)
+{
+    AVDictionaryEntry *t = NULL;
+    struct AVSHA *sha;
+    uint8_t digest[20];
+    char *opts;
+    int ret;
+
+    if (!(sha = av_sha_alloc()))
+        return AVERROR(ENOMEM);
+    av_sha_init(sha, 160);
+
+    hash_int(sha, LIBAVFORMAT_VERSION_INT);
+    hash_int(sha, s->probesize);
+    hash_int(sha, s->format_probesize);
+    hash_int(sha, s->max_analyze_duration);
+    hash_int(sha, s->fps_probe_size);
+    hash_int(sha, s->video_codec_id);
+    hash_int(sha, s->audio_codec_id);
+    hash_int(sha, s->subtitle_codec_id);
+    hash_int(sha, s->data_codec_id);
+
+    /* the generic options such as fflags or skip_initial_bytes, and the
+     * options left for the demuxer, can change the streams it creates */
+    if ((ret = av_opt_serialize(s, AV_OPT_FLAG_DECODING_PARAM,
+                                AV_OPT_SERIALIZE_SKIP_DEFAULTS, &opts, '=', ':')) < 0)
+        goto end;
+    hash_str(sha, opts);
+    av_free(opts);
+    while ((t = av_dict_get(options, "", t, AV_DICT_IGNORE_SUFFIX))) {
+        hash_str(sha, t->key);
+        hash_str(sha, t->value);
+    }
+
+    if ((ret = ff_probe_cache_hash_input(s, sha)) >= 0) {
+        av_sha_final(sha, digest);
+        ff_data_to_hex(key, digest, sizeof(digest), 1);
+        key[2 * sizeof(digest)] = 0;
+    }
+
+end:
+    av_free(sha);
+    return ret;
+}
+
+static char *entry_path(AVFormatContext *s, const char *suffix)
+{
+    return av_asprintf("file:%s/%s%s", s->probe_cache,
+                       s->internal->probe_cache_key, suffix);
+}
+
+static void read_rational(AVIOContext *pb, AVRational *q)
+{
+    q->num = avio_rb32(pb);
+    q->den = avio_rb32(pb);
+}
+
+static int read_codecpar(AVIOContext *pb, AVCodecParameters *par)
+{
+    par->codec_type            = (int)avio_rb32(pb);
+    par->codec_id              = avio_rb32(pb);
+    par->codec_tag             = avio_rb32(pb);
+    par->format                = (int)avio_rb32(pb);
+    par->bit_rate              = avio_rb64(pb);
+    par->bits_per_coded_sample = avio_rb32(pb);
+    par->bits_per_raw_sample   = avio_rb32(pb);
+    par->profile               = (int)avio_rb32(pb);
+    par->level                 = (int)avio_rb32(pb);
+    par->width                 = avio_rb32(pb);
+    par->height                = avio_rb32(pb);
+    read_rational(pb, &par->sample_aspect_ratio);
+    par->field_order           = avio_rb32(pb);
+    par->color_range           = avio_rb32(pb);
+    par->color_primaries       = avio_rb32(pb);
+    par->color_trc             = avio_rb32(pb);
+    par->color_space           = avio_rb32(pb);
+    par->chroma_location       = avio_rb32(pb);
+    par->video_delay           = avio_rb32(pb);
+    par->channel_layout        = avio_rb64(pb);
+    par->channels              = avio_rb32(pb);
+    par->sample_rate           = avio_rb32(pb);
+    par->block_align           = avio_rb32(pb);
+    par->frame_size            = avio_rb32(pb);
+    par->initial_padding       = avio_rb32(pb);
+    par->trailing_padding      = avio_rb32(pb);
+    par->seek_preroll          = avio_rb32(pb);
+
+    par->extradata_size = avio_rb32(pb);
+    if (par->extradata_size < 0 || par->extradata_size > INT_MAX / 2)
+        return AVERROR_INVALIDDATA;
+    if (par->extradata_size) {
+        par->extradata = av_mallocz(par->extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (!par->extradata)
+            return AVERROR(ENOMEM);
+        if (avio_read(pb, par->extradata, par->extradata_size) != par->extradata_size)
+            return AVERROR_INVALIDDATA;
+    }
+    return 0;
+}
+
+static int read_entry(AVIOContext *pb, ProbeCacheEntry *entry)
+{
+    int i, ret;
+
+    if (avio_rb32(pb) != PROBE_CACHE_MAGIC || avio_rb32(pb) != PROBE_CACHE_VERSION)
+        return AVERROR_INVALIDDATA;
+
+    avio_get_str(pb, INT_MAX, entry->format_name, sizeof(entry->format_name));
+    avio_read(pb, entry->layout, sizeof(entry->layout));
+    entry->probe_score                = avio_rb32(pb);
+    entry->start_time                 = avio_rb64(pb);
+    entry->duration                   = avio_rb64(pb);
+    entry->bit_rate                   = avio_rb64(pb);
+    entry->duration_estimation_method = avio_rb32(pb);
+
+    entry->nb_streams = avio_rb32(pb);
+    if (entry->nb_streams < 0 || entry->nb_streams > INT_MAX / sizeof(*entry->streams))
+        return AVERROR_INVALIDDATA;
+    entry->streams = av_mallocz_array(entry->nb_streams, sizeof(*entry->streams));
+    if (entry->nb_streams && !entry->streams) {
+        entry->nb_streams = 0;
+        return AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < entry->nb_streams; i++) {
+        ProbeCacheStream *cst = &entry->streams[i];
+
+        cst->id                   = avio_rb32(pb);
+        cst->disposition          = avio_rb32(pb);
+        cst->start_time           = avio_rb64(pb);
+        cst->duration             = avio_rb64(pb);
+        read_rational(pb, &cst->avg_frame_rate);
+        read_rational(pb, &cst->r_frame_rate);
+        read_rational(pb, &cst->sample_aspect_ratio);
+        read_rational(pb, &cst->codec_time_base);
+        cst->ticks_per_frame      = avio_rb32(pb);
+        cst->codec_info_nb_frames = avio_rb32(pb);
+
+        if (!(cst->par = avcodec_parameters_alloc()))
+            return AVERROR(ENOMEM);
+        if ((ret = read_codecpar(pb, cst->par)) < 0)
+            return ret;
+        if (pb->error || avio_feof(pb))
+            return AVERROR_INVALIDDATA;
+    }
+    return 0;
+}
+
+static void write_rational(AVIOContext *pb, AVRational q)
+{
+    avio_wb32(pb, q.num);
+    avio_wb32(pb, q.den);
+}
+
+static void write_codecpar(AVIOContext *pb, const AVCodecParameters *par)
+{
+    avio_wb32(pb, par->codec_type);
+    avio_wb32(pb, par->codec_id);
+    avio_wb32(pb, par->codec_tag);
+    avio_wb32(pb, par->format);
+    avio_wb64(pb, par->bit_rate);
+    avio_wb32(pb, par->bits_per_coded_sample);
+    avio_wb32(pb, par->bits_per_raw_sample);
+    avio_wb32(pb, par->profile);
+    avio_wb32(pb, par->level);
+    avio_wb32(pb, par->width);
+    avio_wb32(pb, par->height);
+    write_rational(pb, par->sample_aspect_ratio);
+    avio_wb32(pb, par->field_order);
+    avio_wb32(pb, par->color_range);
+    avio_wb32(pb, par->color_primaries);
+    avio_wb32(pb, par->color_trc);
+    avio_wb32(pb, par->color_space);
+    avio_wb32(pb, par->chroma_location);
+    avio_wb32(pb, par->video_delay);
+    avio_wb64(pb, par->channel_layout);
+    avio_wb32(pb, par->channels);
+    avio_wb32(pb, par->sample_rate);
+    avio_wb32(pb, par->block_align);
+    avio_wb32(pb, par->frame_size);
+    avio_wb32(pb, par->initial_padding);
+    avio_wb32(pb, par->trailing_padding);
+    avio_wb32(pb, par->seek_preroll);
+    avio_wb32(pb, par->extradata_size);
+    avio_write(pb, par->extradata, par->extradata_size);
+}
+
+static void write_entry(AVIOContext *pb, AVFormatContext *s)
+{
+    int i;
+
+    avio_wb32(pb, PROBE_CACHE_MAGIC);
+    avio_wb32(pb, PROBE_CACHE_VERSION);
+
+    avio_put_str(pb, s->iformat->name);
+    avio_write(pb, s->internal->probe_cache_layout, sizeof(s->internal->probe_cache_layout));
+    avio_wb32(pb, s->probe_score);
+    avio_wb64(pb, s->start_time);
+    avio_wb64(pb, s->duration);
+    avio_wb64(pb, s->bit_rate);
+    avio_wb32(pb, s->duration_estimation_method);
+
+    avio_wb32(pb, s->nb_streams);
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+
+        avio_wb32(pb, st->id);
+        avio_wb32(pb, st->disposition);
+        avio_wb64(pb, st->start_time);
+        avio_wb64(pb, st->duration);
+        write_rational(pb, st->avg_frame_rate);
+        write_rational(pb, st->r_frame_rate);
+        write_rational(pb, st->sample_aspect_ratio);
+        write_rational(pb, st->internal->avctx->time_base);
+        avio_wb32(pb, st->internal->avctx->ticks_per_frame);
+        avio_wb32(pb, st->codec_info_nb_frames);
+        write_codecpar(pb, st->codecpar);
+    }
+}
+
+/**
+ * Hash the streams created by the demuxer before any probing.
+ */
+static int compute_layout(AVFormatContext *s, uint8_t *layout)
+{
+    struct AVSHA *sha;
+    int i;
+
+    if (!(sha = av_sha_alloc()))
+        return AVERROR(ENOMEM);
+    av_sha_init(sha, 8 * PROBE_CACHE_LAYOUT_SIZE);
+
+    hash_int(sha, s->nb_streams);
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+
+        hash_int(sha, st->id);
+        hash_int(sha, st->codecpar->codec_type);
+        hash_int(sha, st->codecpar->codec_id);
+    }
+    av_sha_final(sha, layout);
+
+    av_free(sha);
+    return 0;
+}
+
+int ff_probe_cache_lookup(AVFormatContext *s, AVDictionary *options)
+{
+    AVFormatInternal *internal = s->internal;
+    AVInputFormat *fmt;
+    AVIOContext *pb = NULL;
+    char *path;
+    int ret;
+
+    if (!s->probe_cache || !s->pb || internal->probe_cache_key[0])
+        return 0;
+
+    if ((ret = compute_key(s, options, internal->probe_cache_key)) < 0) {
+        av_log(s, AV_LOG_DEBUG, "Input cannot be fingerprinted, not using the probe cache\n");
+        return 0;
+    }
+
+    if (!(path = entry_path(s, "")))
+        return AVERROR(ENOMEM);
+    ret = avio_open(&pb, path, AVIO_FLAG_READ);
+    av_free(path);
+    if (ret < 0) {
+        av_log(s, AV_LOG_DEBUG, "Probe cache miss for %s\n", internal->probe_cache_key);
+        return 0;
+    }
+
+    if (!(internal->probe_cache_entry = av_mallocz(sizeof(*internal->probe_cache_entry)))) {
+        avio_closep(&pb);
+        return AVERROR(ENOMEM);
+    }
+    ret = read_entry(pb, internal->probe_cache_entry);
+    avio_closep(&pb);
+    if (ret < 0) {
+        av_log(s, AV_LOG_WARNING, "Invalid probe cache entry %s\n", internal->probe_cache_key);
+        entry_free(&internal->probe_cache_entry);
+        return ret == AVERROR(ENOMEM) ? ret : 0;
+    }
+
+    av_log(s, AV_LOG_DEBUG, "Probe cache hit for %s\n", internal->probe_cache_key);
+    if (s->iformat)
+        return 0;
+    if (!(fmt = av_find_input_format(internal->probe_cache_entry->format_name)) ||
+        fmt->flags & AVFMT_NOFILE)
+        return 0;
+    s->iformat = fmt;
+    return FFMAX(internal->probe_cache_entry->probe_score, 1);
+}
+
+int ff_probe_cache_apply(AVFormatContext *s)
+{
+    AVFormatInternal *internal = s->internal;
+    ProbeCacheEntry *entry     = internal->probe_cache_entry;
+    int i, ret;
+
+    if (!internal->probe_cache_key[0])
+        return 0;
+    /* the codecs are refined while probing, so the streams are compared as
+     * they were created by the demuxer */
+    if ((ret = compute_layout(s, internal->probe_cache_layout)) < 0)
+        return ret;
+    if (!entry)
+        return 0;
+
+    if (strcmp(entry->format_name, s->iformat->name) ||
+        entry->nb_streams != s->nb_streams ||
+        memcmp(entry->layout, internal->probe_cache_layout, sizeof(entry->layout)))
+        goto mismatch;
+
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st          = s->streams[i];
+        ProbeCacheStream *cst = &entry->streams[i];
+        AVCodecContext *avctx = st->internal->avctx;
+
+        if ((ret = avcodec_parameters_copy(st->codecpar, cst->par)) < 0)
+            return ret;
+        st->disposition          = cst->disposition;
+        st->start_time           = cst->start_time;
+        st->duration             = cst->duration;
+        st->avg_frame_rate       = cst->avg_frame_rate;
+        st->r_frame_rate         = cst->r_frame_rate;
+        st->sample_aspect_ratio  = cst->sample_aspect_ratio;
+        st->codec_info_nb_frames = cst->codec_info_nb_frames;
+        if (st->request_probe > 0)
+            st->request_probe = -1;
+
+        if ((ret = avcodec_parameters_to_context(avctx, st->codecpar)) < 0)
+            return ret;
+        avctx->time_base       = cst->codec_time_base;
+        avctx->ticks_per_frame = cst->ticks_per_frame;
+
+#if FF_API_LAVF_AVCTX
+FF_DISABLE_DEPRECATION_WARNINGS
+        if ((ret = avcodec_parameters_to_context(st->codec, st->codecpar)) < 0)
+            return ret;
+        if (st->codec->codec_tag != MKTAG('t','m','c','d')) {
+            st->codec->time_base       = avctx->time_base;
+            st->codec->ticks_per_frame = avctx->ticks_per_frame;
+        }
+        st->codec->framerate = st->avg_frame_rate;
+FF_ENABLE_DEPRECATION_WARNINGS
+#endif
+    }
+
+    s->start_time                 = entry->start_time;
+    s->duration                   = entry->duration;
+    s->bit_rate                   = entry->bit_rate;
+    s->duration_estimation_method = entry->duration_estimation_method;
+
+    entry_free(&s->internal->probe_cache_entry);
+    return 1;
+
+mismatch:
+    av_log(s, AV_LOG_DEBUG, "Probe cache entry does not match the streams, ignoring it\n");
+    entry_free(&s->internal->probe_cache_entry);
+    return 0;
+}
+
+void ff_probe_cache_store(AVFormatContext *s)
+{
+    AVIOContext *pb = NULL;
+    char suffix[32];
+    char *tmp_path = NULL, *path = NULL;
+    int ret;
+
+    if (!s->probe_cache || !s->internal->probe_cache_key[0])
+        return;
+
+    snprintf(suffix, sizeof(suffix), ".%08x.tmp", av_get_random_seed());
+    tmp_path = entry_path(s, suffix);
+    path     = entry_path(s, "");
+    if (!tmp_path || !path)
+        goto end;
+
+    if ((ret = avio_open(&pb, tmp_path, AVIO_FLAG_WRITE)) < 0) {
+        av_log(s, AV_LOG_WARNING, "Could not create probe cache entry %s\n", tmp_path);
+        goto end;
+    }
+    write_entry(pb, s);
+    avio_flush(pb);
+    ret = pb->error;
+    avio_closep(&pb);
+
+    /* the rename makes the entry visible atomically to concurrent readers */
+    if (ret < 0 || avpriv_io_move(tmp_path, path) < 0)
+        avpriv_io_delete(tmp_path);
+
+end:
+    av_free(tmp_path);
+    av_free(path);
+}
+
+void ff_probe_cache_free(AVFormatContext *s)
+{
+    if (s->internal)
+        entry_free(&s->internal->probe_cache_entry);
+}
@@ -0,0 +1,73 @@
+/*
+ * Persistent cache of probing results
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_PROBECACHE_H
+#define AVFORMAT_PROBECACHE_H
+
+#include "avformat.h"
+
+struct AVSHA;
+
+/**
+ * Add the identity of the input opened in s->pb to a hash: its size,
+ * modification time and the content of its first and last 64 KiB.
+ * The position of s->pb is preserved.
+ *
+ * @return 0 on success, AVERROR(ENOSYS) if the input is not seekable or has
+ *         no known size, another negative error code on failure
+ */
+int ff_probe_cache_hash_input(AVFormatContext *s, struct AVSHA *sha);
+
+/**
+ * Compute the fingerprint of the input opened in s->pb and look it up in
+ * the cache directory set by AVFormatContext.probe_cache. The options of s
+ * and the options left in options for the demuxer are part of the
+ * fingerprint.
+ * The position of s->pb is preserved.
+ *
+ * If an entry is found and s->iformat is not set yet, s->iformat is set to
+ * the cached format.
+ *
+ * @return the cached probe score if s->iformat was set, 0 otherwise
+ */
+int ff_probe_cache_lookup(AVFormatContext *s, AVDictionary *options);
+
+/**
+ * Set the stream parameters from the entry found by ff_probe_cache_lookup(),
+ * if it matches the ids, types and codecs of the streams created by the
+ * demuxer. Must be called before the streams are probed.
+ *
+ * @return 1 if the parameters were set, 0 if probing must be done,
+ *         a negative error code on failure
+ */
+int ff_probe_cache_apply(AVFormatContext *s);
+
+/**
+ * Store the parameters found by avformat_find_stream_info() in the cache.
+ * Does nothing if the input has no fingerprint.
+ */
+void ff_probe_cache_store(AVFormatContext *s);
+
+/**
+ * Free the cache state of s.
+ */
+void ff_probe_cache_free(AVFormatContext *s);
+
+#endif /* AVFORMAT_PROBECACHE_H */
@@ -0,0 +1,316 @@
+/*
+ * Sidecar keyframe index files
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Sidecar files holding the index entries of the streams of an input.
+ *
+ * The entries are those the demuxer built while reading the input, or for
+ * the demuxers seeking with the generic code, the positions of the keyframes
+ * read. Loading them spares the binary search or the linear scan the
+ * demuxers without an index in the container do on every seek.
+ * The file is tied to the input by the same fingerprint as the probe cache.
+ */
+
+#include "libavutil/intreadwrite.h"
+#include "libavutil/random_seed.h"
+#include "libavutil/sha.h"
+#include "avformat.h"
+#include "avio_internal.h"
+#include "internal.h"
+#include "probecache.h"
+#include "seekindex.h"
+
+#define SEEK_INDEX_MAGIC   MKBETAG('F', 'F', 'S', 'I')
+#define SEEK_INDEX_VERSION 1
+/* pos, timestamp, size, min_distance, flags */
+#define SEEK_INDEX_ENTRY_SIZE 28
+
+static int compute_key(AVFormatContext *s, uint8_t *key)
+{
+    struct AVSHA *sha;
+    int ret;
+
+    if (!(sha = av_sha_alloc()))
+        return AVERROR(ENOMEM);
+    av_sha_init(sha, 160);
+    if ((ret = ff_probe_cache_hash_input(s, sha)) >= 0)
+        av_sha_final(sha, key);
+    av_free(sha);
+    return ret;
+}
+
+/* the entries of the packets split by a parser have no position, and
+ * cannot be seeked to */
+static int count_stream_entries(const AVStream *st)
+{
+    int nb_entries = 0, i;
+
+    for (i = 0; i < st->nb_index_entries; i++)
+        nb_entries += st->index_entries[i].pos >= 0;
+    return nb_entries;
+}
+
+static int64_t count_entries(AVFormatContext *s)
+{
+    int64_t nb_entries = 0;
+    int i;
+
+    for (i = 0; i < s->nb_streams; i++)
+        nb_entries += count_stream_entries(s->streams[i]);
+    return nb_entries;
+}
+
+/* Only the demuxers which seek with the generic code use the index entries
+ * they did not build themselves. */
+static int has_seek_index(AVFormatContext *s)
+{
+    return s->seek_index && s->pb && s->iformat &&
+           !(s->iformat->flags & AVFMT_NOFILE) &&
+           !s->iformat->read_seek && !s->iformat->read_seek2;
+}
+
+int ff_seek_index_generic(AVFormatContext *s)
+{
+    return s->iformat->flags & AVFMT_GENERIC_INDEX ||
+           (has_seek_index(s) && !s->internal->seek_index_searching);
+}
+
+static int read_index(AVFormatContext *s, AVIOContext *pb, int64_t *nb_read)
+{
+    AVIndexEntry **entries;
+    unsigned *nb_entries;
+    uint8_t key[20], file_key[20];
+    int i, j, ret;
+
+    if (avio_rb32(pb) != SEEK_INDEX_MAGIC || avio_rb32(pb) != SEEK_INDEX_VERSION)
+        return AVERROR_INVALIDDATA;
+    if (avio_read(pb, file_key, sizeof(file_key)) != sizeof(file_key))
+        return AVERROR_INVALIDDATA;
+    if ((ret = compute_key(s, key)) < 0)
+        return ret;
+    if (memcmp(key, file_key, sizeof(key)) ||
+        avio_rb32(pb) != s->nb_streams)
+        return AVERROR(EINVAL);
+
+    /* the whole file is read before any entry is added to the streams,
+     * so that a truncated or mismatching index leaves them untouched */
+    entries    = av_mallocz_array(s->nb_streams, sizeof(*entries));
+    nb_entries = av_mallocz_array(s->nb_streams, sizeof(*nb_entries));
+    if (!entries || !nb_entries) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        int id = avio_rb32(pb);
+        AVRational tb;
+
+        tb.num        = avio_rb32(pb);
+        tb.den        = avio_rb32(pb);
+        nb_entries[i] = avio_rb32(pb);
+
+        if (id != st->id || av_cmp_q(tb, st->time_base)) {
+            ret = AVERROR(EINVAL);
+            goto end;
+        }
+        if (avio_feof(pb) ||
+            nb_entries[i] > (avio_size(pb) - avio_tell(pb)) / SEEK_INDEX_ENTRY_SIZE) {
+            ret = AVERROR_INVALIDDATA;
+            goto end;
+        }
+        if (!(entries[i] = av_malloc_array(nb_entries[i], sizeof(**entries)))) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+
+        for (j = 0; j < nb_entries[i]; j++) {
+            AVIndexEntry *ie = &entries[i][j];
+
+            ie->pos          = avio_rb64(pb);
+            ie->timestamp    = avio_rb64(pb);
+            ie->size         = avio_rb32(pb);
+            ie->min_distance = avio_rb32(pb);
+            ie->flags        = avio_rb32(pb);
+            if (ie->pos < 0 || ie->timestamp == AV_NOPTS_VALUE) {
+                ret = AVERROR_INVALIDDATA;
+                goto end;
+            }
+        }
+        if (avio_feof(pb)) {
+            ret = AVERROR_INVALIDDATA;
+            goto end;
+        }
+    }
+    if ((ret = pb->error) < 0)
+        goto end;
+
+    /* make room for all the entries, adding them cannot fail then */
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        AVIndexEntry *ie;
+
+        if ((unsigned)st->nb_index_entries + nb_entries[i] >=
+            UINT_MAX / sizeof(*ie)) {
+            ret = AVERROR_INVALIDDATA;
+            goto end;
+        }
+        ie = av_fast_realloc(st->index_entries, &st->index_entries_allocated_size,
+                             (st->nb_index_entries + nb_entries[i]) * sizeof(*ie));
+        if (!ie) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        st->index_entries = ie;
+    }
+
+    for (i = 0; i < s->nb_streams; i++) {
+        for (j = 0; j < nb_entries[i]; j++) {
+            const AVIndexEntry *ie = &entries[i][j];
+
+            av_add_index_entry(s->streams[i], ie->pos, ie->timestamp,
+                               ie->size, ie->min_distance, ie->flags);
+        }
+        *nb_read += nb_entries[i];
+    }
+    ret = 0;
+
+end:
+    for (i = 0; entries && i < s->nb_streams; i++)
+        av_free(entries[i]);
+    av_free(entries);
+    av_free(nb_entries);
+    return ret;
+}
+
+int ff_seek_index_load(AVFormatContext *s)
+{
+    AVFormatInternal *internal = s->internal;
+    AVIOContext *pb = NULL;
+    char *path;
+    int ret;
+
+    if (!has_seek_index(s))
+        return 0;
+    if (internal->seek_index_state)
+        return internal->seek_index_state > 0;
+    internal->seek_index_state = -1;
+
+    if (!(path = av_asprintf("file:%s", s->seek_index)))
+        return 0;
+    ret = avio_open(&pb, path, AVIO_FLAG_READ);
+    av_free(path);
+    if (ret < 0) {
+        av_log(s, AV_LOG_DEBUG, "No seek index in %s\n", s->seek_index);
+        return 0;
+    }
+
+    ret = read_index(s, pb, &internal->seek_index_nb_entries);
+    avio_closep(&pb);
+    if (ret < 0) {
+        av_log(s, AV_LOG_WARNING, "Seek index %s %s, ignoring it\n", s->seek_index,
+               ret == AVERROR(EINVAL) ? "does not match the input" : "is invalid");
+        internal->seek_index_nb_entries = 0;
+        return 0;
+    }
+
+    av_log(s, AV_LOG_VERBOSE, "Loaded %"PRId64" index entries from %s\n",
+           internal->seek_index_nb_entries, s->seek_index);
+    internal->seek_index_state = 1;
+    return 1;
+}
+
+static void write_index(AVFormatContext *s, AVIOContext *pb, const uint8_t *key)
+{
+    int i, j;
+
+    avio_wb32(pb, SEEK_INDEX_MAGIC);
+    avio_wb32(pb, SEEK_INDEX_VERSION);
+    avio_write(pb, key, 20);
+
+    avio_wb32(pb, s->nb_streams);
+    for (i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+
+        avio_wb32(pb, st->id);
+        avio_wb32(pb, st->time_base.num);
+        avio_wb32(pb, st->time_base.den);
+        avio_wb32(pb, count_stream_entries(st));
+        for (j = 0; j < st->nb_index_entries; j++) {
+            const AVIndexEntry *ie = &st->index_entries[j];
+
+            if (ie->pos < 0)
+                continue;
+            avio_wb64(pb, ie->pos);
+            avio_wb64(pb, ie->timestamp);
+            avio_wb32(pb, ie->size);
+            avio_wb32(pb, ie->min_distance);
+            avio_wb32(pb, ie->flags);
+        }
+    }
+}
+
+void ff_seek_index_store(AVFormatContext *s)
+{
+    AVIOContext *pb = NULL;
+    uint8_t key[20];
+    char *tmp_path = NULL, *path = NULL;
+    int ret;
+
+    if (!has_seek_index(s))
+        return;
+
+    /* merge the entries of an existing index first, so that it never
+     * shrinks when the input was only partly read */
+    ff_seek_index_load(s);
+    if (count_entries(s) <= s->internal->seek_index_nb_entries)
+        return;
+
+    if (compute_key(s, key) < 0) {
+        av_log(s, AV_LOG_DEBUG, "Input cannot be fingerprinted, not writing the seek index\n");
+        return;
+    }
+
+    tmp_path = av_asprintf("file:%s.%08x.tmp", s->seek_index, av_get_random_seed());
+    path     = av_asprintf("file:%s", s->seek_index);
+    if (!tmp_path || !path)
+        goto end;
+
+    if ((ret = avio_open(&pb, tmp_path, AVIO_FLAG_WRITE)) < 0) {
+        av_log(s, AV_LOG_WARNING, "Could not create seek index %s\n", tmp_path);
+        goto end;
+    }
+    write_index(s, pb, key);
+    avio_flush(pb);
+    ret = pb->error;
+    avio_closep(&pb);
+
+    /* concurrent readers see either the previous index or the new one */
+    if (ret < 0 || avpriv_io_move(tmp_path, path) < 0)
+        avpriv_io_delete(tmp_path);
+    else
+        av_log(s, AV_LOG_VERBOSE, "Wrote %"PRId64" index entries to %s\n",
+               count_entries(s), s->seek_index);
+
+end:
+    av_free(tmp_path);
+    av_free(path);
+}
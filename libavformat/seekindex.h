@@ -0,0 +1,48 @@
+/*
+ * Sidecar keyframe index files
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_SEEKINDEX_H
+#define AVFORMAT_SEEKINDEX_H
+
+#include "avformat.h"
+
+/**
+ * Whether the keyframes read from s must be added to the stream indexes
+ * by the generic code, either because the demuxer relies on it to seek or
+ * because they are collected for the sidecar index.
+ */
+int ff_seek_index_generic(AVFormatContext *s);
+
+/**
+ * Load the index entries of the file set by AVFormatContext.seek_index, if
+ * it was written for the same input and streams. Only done once, before the
+ * first seek.
+ *
+ * @return 1 if the index entries were loaded, 0 otherwise
+ */
+int ff_seek_index_load(AVFormatContext *s);
+
+/**
+ * Write the index entries of the streams to the file set by
+ * AVFormatContext.seek_index, if they changed since it was loaded.
+ */
+void ff_seek_index_store(AVFormatContext *s);
+
+#endif /* AVFORMAT_SEEKINDEX_H */
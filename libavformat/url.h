@@ -33,8 +33,21 @@
 #define URL_PROTOCOL_FLAG_NESTED_SCHEME 1 /*< The protocol name can be the first part of a nested protocol scheme */
 #define URL_PROTOCOL_FLAG_NETWORK       2 /*< The protocol uses network */
 
+/**
+ * Maximum number of elements accepted by a single vectored write.
+ */
+#define URL_MAX_IOV 16
+
 extern const AVClass ffurl_context_class;
 
+/**
+ * One element of a vectored (scatter/gather) write.
+ */
+typedef struct URLIOVec {
+    const uint8_t *data;
+    int size;
+} URLIOVec;
+
 typedef struct URLContext {
     const AVClass *av_class;    /**< information for av_log(). Set by url_open(). */
     const struct URLProtocol *prot;
@@ -95,6 +108,11 @@ typedef struct URLProtocol {
     int (*url_delete)(URLContext *h);
     int (*url_move)(URLContext *h_src, URLContext *h_dst);
     const char *default_whitelist;
+    /**
+     * Write iovcnt buffers (at most URL_MAX_IOV) in order, as if they were
+     * concatenated. Like url_write, may write less than requested.
+     */
+    int (*url_writev)(URLContext *h, const URLIOVec *iov, int iovcnt);
 } URLProtocol;
 
 /**
@@ -200,6 +218,16 @@ int ffurl_read_complete(URLContext *h, unsigned char *buf, int size);
  */
 int ffurl_write(URLContext *h, const unsigned char *buf, int size);
 
+/**
+ * Write the iovcnt buffers described by iov, in order, to the resource
+ * accessed by h. A single vectored write is issued to the protocol if it
+ * supports it, otherwise the buffers are written one after the other.
+ *
+ * @return the number of bytes actually written, or a negative value
+ * corresponding to an AVERROR code in case of failure
+ */
+int ffurl_writev(URLContext *h, const URLIOVec *iov, int iovcnt);
+
 /**
  * Change the position that will be used by the next read/write
  * operation on the resource accessed by h.
@@ -26,12 +26,14 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
+#include "libavutil/cpu.h"
 #include "libavutil/dict.h"
 #include "libavutil/internal.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/time_internal.h"
 #include "libavutil/timestamp.h"
@@ -44,6 +46,8 @@
 #include "avformat.h"
 #include "avio_internal.h"
 #include "id3v2.h"
+#include "probecache.h"
+#include "seekindex.h"
 #include "internal.h"
 #include "metadata.h"
 #if CONFIG_NETWORK
@@ -402,6 +406,8 @@ static int init_input(AVFormatContext *s, const char *filename,
 
     if (s->pb) {
         s->flags |= AVFMT_FLAG_CUSTOM_IO;
+        if ((ret = ff_probe_cache_lookup(s, *options)) != 0)
+            return ret;
         if (!s->iformat)
             return av_probe_input_buffer2(s->pb, &s->iformat, filename,
                                          s, 0, s->format_probesize);
@@ -418,6 +424,8 @@ static int init_input(AVFormatContext *s, const char *filename,
     if ((ret = s->io_open(s, &s->pb, filename, AVIO_FLAG_READ | s->avio_flags, options)) < 0)
         return ret;
 
+    if ((ret = ff_probe_cache_lookup(s, *options)) != 0)
+        return ret;
     if (s->iformat)
         return 0;
     return av_probe_input_buffer2(s->pb, &s->iformat, filename,
@@ -1455,6 +1463,17 @@ static int parse_packet(AVFormatContext *s, AVPacket *pkt, int stream_index)
 
         compute_pkt_fields(s, st, st->parser, &out_pkt, next_dts, next_pts);
 
+        /* the parser output the start of the input packet as is,
+         * reference it rather than copying the payload */
+        if (pkt->buf && out_pkt.data == pkt->data) {
+            out_pkt.buf = av_buffer_ref(pkt->buf);
+            if (!out_pkt.buf) {
+                av_packet_unref(&out_pkt);
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        }
+
         ret = add_to_pktbuf(&s->internal->parse_queue, &out_pkt,
                             &s->internal->parse_queue_end, 1);
         av_packet_unref(&out_pkt);
@@ -1590,7 +1609,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
             /* no parsing needed: we just output the packet as is */
             *pkt = cur_pkt;
             compute_pkt_fields(s, st, NULL, pkt, AV_NOPTS_VALUE, AV_NOPTS_VALUE);
-            if ((s->iformat->flags & AVFMT_GENERIC_INDEX) &&
+            if (ff_seek_index_generic(s) &&
                 (pkt->flags & AV_PKT_FLAG_KEY) && pkt->dts != AV_NOPTS_VALUE) {
                 ff_reduce_index(s, st->index);
                 av_add_index_entry(st, pkt->pos, pkt->dts,
@@ -1777,7 +1796,7 @@ int av_read_frame(AVFormatContext *s, AVPacket *pkt)
 return_packet:
 
     st = s->streams[pkt->stream_index];
-    if ((s->iformat->flags & AVFMT_GENERIC_INDEX) && pkt->flags & AV_PKT_FLAG_KEY) {
+    if (ff_seek_index_generic(s) && pkt->flags & AV_PKT_FLAG_KEY) {
         ff_reduce_index(s, st->index);
         av_add_index_entry(st, pkt->pos, pkt->dts, 0, 0, AVINDEX_KEYFRAME);
     }
@@ -2143,8 +2162,10 @@ int ff_seek_frame_binary(AVFormatContext *s, int stream_index,
         }
     }
 
+    s->internal->seek_index_searching = 1;
     pos = ff_gen_search(s, stream_index, target_ts, pos_min, pos_max, pos_limit,
                         ts_min, ts_max, flags, &ts, avif->read_timestamp);
+    s->internal->seek_index_searching = 0;
     if (pos < 0)
         return -1;
 
@@ -2413,6 +2434,16 @@ static int seek_frame_internal(AVFormatContext *s, int stream_index,
                                AV_TIME_BASE * (int64_t) st->time_base.num);
     }
 
+    /* with the keyframes of a sidecar index covering the target, a single
+     * seek is enough */
+    st = s->streams[stream_index];
+    if (ff_seek_index_load(s) && st->nb_index_entries &&
+        timestamp <= st->index_entries[st->nb_index_entries - 1].timestamp) {
+        ff_read_frame_flush(s);
+        if (seek_frame_generic(s, stream_index, timestamp, flags) >= 0)
+            return 0;
+    }
+
     /* first, we try the format specific seek */
     if (s->iformat->read_seek) {
         ff_read_frame_flush(s);
@@ -3027,6 +3058,208 @@ fail:
     return ret;
 }
 
+#define PROBE_BATCH_SIZE 128
+
+typedef struct ProbeBatchEntry {
+    AVPacket pkt;
+    /* value of st->codec_info_nb_frames when the packet was read */
+    int codec_info_nb_frames;
+} ProbeBatchEntry;
+
+/**
+ * Packets read by avformat_find_stream_info() whose decoding is deferred,
+ * so that the packets of different streams can be decoded in parallel.
+ */
+typedef struct ProbeBatch {
+    AVFormatContext *ic;
+    AVDictionary **options;
+    int orig_nb_streams;
+    int nb_threads;
+
+    ProbeBatchEntry entries[PROBE_BATCH_SIZE];
+    int nb_entries;
+
+    /* streams lacking codec parameters when the batch was started, the
+     * batch is decoded once each of them has a packet in it */
+    int wanted[PROBE_BATCH_SIZE];
+    int nb_wanted;
+    int nb_wanted_missing;
+
+    /* streams with packets in the batch, handed out to the workers */
+    int streams[PROBE_BATCH_SIZE];
+    int nb_streams;
+    int next_stream;
+#if HAVE_THREADS
+    pthread_mutex_t lock;
+#endif
+} ProbeBatch;
+
+static int probe_batch_add(ProbeBatch *b, AVPacket *pkt, int codec_info_nb_frames)
+{
+    ProbeBatchEntry *e = &b->entries[b->nb_entries];
+    int i, ret;
+
+    if (!b->nb_entries) {
+        b->nb_wanted = 0;
+        for (i = 0; i < b->ic->nb_streams; i++) {
+            if (has_codec_parameters(b->ic->streams[i], NULL))
+                continue;
+            if (b->nb_wanted == PROBE_BATCH_SIZE)
+                break;
+            b->wanted[b->nb_wanted++] = i;
+        }
+        b->nb_wanted_missing = b->nb_wanted;
+    }
+
+    for (i = 0; i < b->nb_entries; i++)
+        if (b->entries[i].pkt.stream_index == pkt->stream_index)
+            break;
+    if (i == b->nb_entries) {
+        for (i = 0; i < b->nb_wanted; i++)
+            if (b->wanted[i] == pkt->stream_index)
+                b->nb_wanted_missing--;
+    }
+
+    if ((ret = av_packet_ref(&e->pkt, pkt)) < 0)
+        return ret;
+    e->codec_info_nb_frames = codec_info_nb_frames;
+    b->nb_entries++;
+    return 0;
+}
+
+static int probe_batch_has_stream(ProbeBatch *b, int stream_index)
+{
+    int i;
+
+    for (i = 0; i < b->nb_entries; i++)
+        if (b->entries[i].pkt.stream_index == stream_index)
+            return 1;
+    return 0;
+}
+
+static int probe_batch_ready(ProbeBatch *b)
+{
+    return b->nb_entries == PROBE_BATCH_SIZE || !b->nb_wanted_missing;
+}
+
+static void probe_batch_decode_stream(ProbeBatch *b, int stream_index)
+{
+    AVStream *st = b->ic->streams[stream_index];
+    int codec_info_nb_frames = st->codec_info_nb_frames;
+    int i;
+
+    for (i = 0; i < b->nb_entries; i++) {
+        ProbeBatchEntry *e = &b->entries[i];
+        if (e->pkt.stream_index != stream_index)
+            continue;
+        /* try_decode_frame() looks at codec_info_nb_frames, give it the
+         * value it would have had without batching */
+        st->codec_info_nb_frames = e->codec_info_nb_frames;
+        try_decode_frame(b->ic, st, &e->pkt,
+                         (b->options && stream_index < b->orig_nb_streams) ?
+                         &b->options[stream_index] : NULL);
+    }
+    st->codec_info_nb_frames = codec_info_nb_frames;
+}
+
+static void *probe_batch_worker(void *arg)
+{
+    ProbeBatch *b = arg;
+
+    for (;;) {
+        int stream_index = -1;
+#if HAVE_THREADS
+        pthread_mutex_lock(&b->lock);
+#endif
+        if (b->next_stream < b->nb_streams)
+            stream_index = b->streams[b->next_stream++];
+#if HAVE_THREADS
+        pthread_mutex_unlock(&b->lock);
+#endif
+        if (stream_index < 0)
+            break;
+        probe_batch_decode_stream(b, stream_index);
+    }
+    return NULL;
+}
+
+/**
+ * Decode the packets of the batch, each stream in its own thread, and
+ * empty it.
+ */
+static void probe_batch_decode(ProbeBatch *b)
+{
+#if HAVE_THREADS
+    pthread_t threads[PROBE_BATCH_SIZE];
+    int nb_threads = 0;
+#endif
+    int i, j;
+
+    b->nb_streams  = 0;
+    b->next_stream = 0;
+    for (i = 0; i < b->nb_entries; i++) {
+        for (j = 0; j < b->nb_streams; j++)
+            if (b->streams[j] == b->entries[i].pkt.stream_index)
+                break;
+        if (j == b->nb_streams)
+            b->streams[b->nb_streams++] = b->entries[i].pkt.stream_index;
+    }
+
+#if HAVE_THREADS
+    /* the calling thread is one of the workers */
+    while (nb_threads < FFMIN(b->nb_threads, b->nb_streams) - 1) {
+        if (pthread_create(&threads[nb_threads], NULL, probe_batch_worker, b))
+            break;
+        nb_threads++;
+    }
+#endif
+    probe_batch_worker(b);
+#if HAVE_THREADS
+    for (i = 0; i < nb_threads; i++)
+        pthread_join(threads[i], NULL);
+#endif
+
+    for (i = 0; i < b->nb_entries; i++)
+        av_packet_unref(&b->entries[i].pkt);
+    b->nb_entries = 0;
+}
+
+static int probe_batch_alloc(ProbeBatch **pb, AVFormatContext *ic,
+                             AVDictionary **options, int nb_threads)
+{
+    ProbeBatch *b = av_mallocz(sizeof(*b));
+
+    if (!b)
+        return AVERROR(ENOMEM);
+#if HAVE_THREADS
+    if (pthread_mutex_init(&b->lock, NULL)) {
+        av_free(b);
+        return AVERROR(ENOMEM);
+    }
+#endif
+    b->ic              = ic;
+    b->options         = options;
+    b->orig_nb_streams = ic->nb_streams;
+    b->nb_threads      = nb_threads;
+    *pb = b;
+    return 0;
+}
+
+static void probe_batch_free(ProbeBatch **pb)
+{
+    ProbeBatch *b = *pb;
+    int i;
+
+    if (!b)
+        return;
+    for (i = 0; i < b->nb_entries; i++)
+        av_packet_unref(&b->entries[i].pkt);
+#if HAVE_THREADS
+    pthread_mutex_destroy(&b->lock);
+#endif
+    av_freep(pb);
+}
+
 unsigned int ff_codec_get_tag(const AVCodecTag *tags, enum AVCodecID id)
 {
     while (tags->id != AV_CODEC_ID_NONE) {
@@ -3380,9 +3613,19 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
     int64_t probesize = ic->probesize;
     int eof_reached = 0;
     int *missing_streams = av_opt_ptr(ic->iformat->priv_class, ic->priv_data, "missing_streams");
+    int probe_threads = ic->probe_threads ? ic->probe_threads : av_cpu_count();
+    ProbeBatch *batch = NULL;
+    int all_found = 1;
 
     flush_codecs = probesize > 0;
 
+    ret = ff_probe_cache_apply(ic);
+    if (ret) {
+        if (ret > 0)
+            ret = 0;
+        goto find_stream_info_err;
+    }
+
     av_opt_set(ic, "skip_clear", "1", AV_OPT_SEARCH_CHILDREN);
 
     max_stream_analyze_duration = max_analyze_duration;
@@ -3486,6 +3729,14 @@ FF_ENABLE_DEPRECATION_WARNINGS
         ic->streams[i]->info->fps_last_dts  = AV_NOPTS_VALUE;
     }
 
+    /* With several threads, packets are decoded in batches in which each
+     * stream is decoded by its own thread. */
+    if (HAVE_THREADS && probe_threads > 1) {
+        ret = probe_batch_alloc(&batch, ic, options, probe_threads);
+        if (ret < 0)
+            goto find_stream_info_err;
+    }
+
     read_size = 0;
     for (;;) {
         int analyzed_all_streams;
@@ -3500,6 +3751,11 @@ FF_ENABLE_DEPRECATION_WARNINGS
             int fps_analyze_framecount = 20;
 
             st = ic->streams[i];
+            /* the parameters may be found by decoding the packets of the
+             * stream still in the batch, as without batching */
+            if (batch && !has_codec_parameters(st, NULL) &&
+                probe_batch_has_stream(batch, i))
+                probe_batch_decode(batch);
             if (!has_codec_parameters(st, NULL))
                 break;
             /* If the timebase is coarse (like the usual millisecond precision
@@ -3679,8 +3935,10 @@ FF_ENABLE_DEPRECATION_WARNINGS
                 avctx->extradata_size = i;
                 avctx->extradata      = av_mallocz(avctx->extradata_size +
                                                    AV_INPUT_BUFFER_PADDING_SIZE);
-                if (!avctx->extradata)
-                    return AVERROR(ENOMEM);
+                if (!avctx->extradata) {
+                    ret = AVERROR(ENOMEM);
+                    goto find_stream_info_err;
+                }
                 memcpy(avctx->extradata, pkt->data,
                        avctx->extradata_size);
             }
@@ -3695,16 +3953,27 @@ FF_ENABLE_DEPRECATION_WARNINGS
          * least one frame of codec data, this makes sure the codec initializes
          * the channel configuration and does not only trust the values from
          * the container. */
-        try_decode_frame(ic, st, pkt,
-                         (options && i < orig_nb_streams) ? &options[i] : NULL);
+        if (batch) {
+            ret = probe_batch_add(batch, pkt, st->codec_info_nb_frames);
+            if (ret < 0)
+                goto find_stream_info_err;
+        } else
+            try_decode_frame(ic, st, pkt,
+                             (options && i < orig_nb_streams) ? &options[i] : NULL);
 
         if (ic->flags & AVFMT_FLAG_NOBUFFER)
             av_packet_unref(pkt);
 
         st->codec_info_nb_frames++;
         count++;
+
+        if (batch && probe_batch_ready(batch))
+            probe_batch_decode(batch);
     }
 
+    if (batch)
+        probe_batch_decode(batch);
+
     if (eof_reached) {
         int stream_index;
         for (stream_index = 0; stream_index < ic->nb_streams; stream_index++) {
@@ -3859,6 +4128,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
         }
         if (!has_codec_parameters(st, &errmsg)) {
             char buf[256];
+            all_found = 0;
             avcodec_string(buf, sizeof(buf), st->internal->avctx, 0);
             av_log(ic, AV_LOG_WARNING,
                    "Could not find codec parameters for stream %d (%s): %s\n"
@@ -3927,7 +4197,11 @@ FF_ENABLE_DEPRECATION_WARNINGS
         st->internal->avctx_inited = 0;
     }
 
+    if (ret >= 0 && all_found)
+        ff_probe_cache_store(ic);
+
 find_stream_info_err:
+    probe_batch_free(&batch);
     for (i = 0; i < ic->nb_streams; i++) {
         st = ic->streams[i];
         if (st->info)
@@ -4183,6 +4457,7 @@ void avformat_free_context(AVFormatContext *s)
     av_dict_free(&s->metadata);
     av_freep(&s->streams);
     flush_packet_queue(s);
+    ff_probe_cache_free(s);
     av_freep(&s->internal);
     av_free(s);
 }
@@ -4204,9 +4479,11 @@ void avformat_close_input(AVFormatContext **ps)
 
     flush_packet_queue(s);
 
-    if (s->iformat)
+    if (s->iformat) {
+        ff_seek_index_store(s);
         if (s->iformat->read_close)
             s->iformat->read_close(s);
+    }
 
     avformat_free_context(s);
 
@@ -0,0 +1,50 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "atomic.h"
+#include "avstring.h"
+#include "mem.h"
+#include "registry.h"
+
+uint32_t avpriv_registry_hash(const char *name, size_t len)
+{
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    // FNV-1a
+    for (i = 0; i < len && name[i]; i++)
+        hash = (hash ^ av_tolower(name[i])) * 16777619U;
+
+    return hash;
+}
+
+void avpriv_registry_add(FFRegistryIndex *index, uint32_t key, const void *item)
+{
+    FFRegistryNode **p = &index->buckets[key % FF_REGISTRY_BUCKETS];
+    FFRegistryNode *node = av_mallocz(sizeof(*node));
+
+    if (!node) {
+        index->incomplete = 1;
+        return;
+    }
+    node->item = item;
+    node->key  = key;
+
+    while (*p || avpriv_atomic_ptr_cas((void * volatile *)p, NULL, node))
+        p = &(*p)->next;
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Hash index of the registered components (codecs, formats, filters),
+ * to look them up without walking the registration lists.
+ *
+ * The index is insert only and lock free like the registration lists:
+ * nodes are appended to the end of their bucket, so that the nodes with
+ * the same key are found in registration order.
+ */
+
+#ifndef AVUTIL_REGISTRY_H
+#define AVUTIL_REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FF_REGISTRY_BUCKETS 256
+
+typedef struct FFRegistryNode {
+    const void *item;
+    uint32_t key;
+    struct FFRegistryNode *next;
+} FFRegistryNode;
+
+/**
+ * Must be zero initialized, typically as a static variable.
+ */
+typedef struct FFRegistryIndex {
+    FFRegistryNode *buckets[FF_REGISTRY_BUCKETS];
+    /**
+     * Set when a node could not be allocated: lookups must then walk
+     * the registration list instead.
+     */
+    int incomplete;
+} FFRegistryIndex;
+
+/**
+ * Hash a name, case insensitively.
+ *
+ * @param len number of characters of name to hash
+ */
+uint32_t avpriv_registry_hash(const char *name, size_t len);
+
+/**
+ * Add an item to the index under the given key.
+ */
+void avpriv_registry_add(FFRegistryIndex *index, uint32_t key, const void *item);
+
+/**
+ * @return the first node of the bucket of key, the nodes with other keys
+ *         in the bucket must be skipped by the caller
+ */
+static inline const FFRegistryNode *ff_registry_bucket(const FFRegistryIndex *index,
+                                                       uint32_t key)
+{
+    return index->buckets[key % FF_REGISTRY_BUCKETS];
+}
+
+#endif /* AVUTIL_REGISTRY_H */
@@ -0,0 +1,53 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_SLICETHREAD_H
+#define AVUTIL_SLICETHREAD_H
+
+/**
+ * @file
+ * Pool of persistent worker threads running the jobs of a parallel loop.
+ */
+
+typedef struct AVSliceThread AVSliceThread;
+
+typedef void (avpriv_slicethread_func)(void *arg, int jobnr, int nb_jobs);
+
+/**
+ * Start a pool of nb_threads worker threads.
+ *
+ * @param pctx       set to the pool on success
+ * @param nb_threads number of threads, must be at least 1
+ * @return the number of threads started on success, AVERROR(ENOSYS) if
+ *         threads are not supported, another negative error code on failure
+ */
+int avpriv_slicethread_create(AVSliceThread **pctx, int nb_threads);
+
+/**
+ * Call func(arg, jobnr, nb_jobs) for each jobnr in [0, nb_jobs) on the
+ * workers of the pool and return once all of them are done.
+ */
+void avpriv_slicethread_execute(AVSliceThread *ctx, avpriv_slicethread_func *func,
+                                void *arg, int nb_jobs);
+
+/**
+ * Stop the workers and free the pool. Does nothing if *pctx is NULL.
+ */
+void avpriv_slicethread_free(AVSliceThread **pctx);
+
+#endif /* AVUTIL_SLICETHREAD_H */
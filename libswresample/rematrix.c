@@ -381,8 +381,77 @@ av_cold static int auto_matrix(SwrContext *s)
     return ret;
 }
 
+/**
+ * Group the output channels mixing more than 2 input channels in blocks of
+ * SWR_MIX_BLOCK, each with the list of the input channels used by any of
+ * its outputs, so that the inputs with only zero coefficients are skipped.
+ */
+static av_cold int init_mix_blocks(SwrContext *s)
+{
+    int coeff_size = s->midbuf.fmt == AV_SAMPLE_FMT_DBLP ? sizeof(double) : sizeof(int);
+    uint8_t outs[SWR_CH_MAX];
+    int nb_outs = 0, nb_coeffs = 0;
+    int i, j, k, b;
+
+    s->nb_mix_blocks = 0;
+    for (i = 0; i < SWR_CH_MAX; i++)
+        if (s->matrix_ch[i][0] > 2)
+            outs[nb_outs++] = i;
+    if (!nb_outs)
+        return 0;
+
+    for (b = 0; b * SWR_MIX_BLOCK < nb_outs; b++) {
+        SwrMixBlock *blk = &s->mix_block[b];
+        uint8_t used[SWR_CH_MAX] = { 0 };
+
+        blk->nb_out = FFMIN(SWR_MIX_BLOCK, nb_outs - b * SWR_MIX_BLOCK);
+        for (k = 0; k < SWR_MIX_BLOCK; k++) {
+            int out_i = outs[FFMIN(b * SWR_MIX_BLOCK + k, nb_outs - 1)];
+            blk->out_ch[k] = out_i;
+            for (j = 1; j <= s->matrix_ch[out_i][0]; j++)
+                used[s->matrix_ch[out_i][j]] = 1;
+        }
+        blk->nb_in = 0;
+        for (j = 0; j < SWR_CH_MAX; j++)
+            if (used[j])
+                blk->in_ch[blk->nb_in++] = j;
+        blk->coeff_offset = nb_coeffs;
+        nb_coeffs += blk->nb_in * SWR_MIX_BLOCK;
+    }
+    s->nb_mix_blocks = b;
+
+    s->native_block_matrix = av_calloc(nb_coeffs, coeff_size);
+    if (!s->native_block_matrix)
+        return AVERROR(ENOMEM);
+
+    for (b = 0; b < s->nb_mix_blocks; b++) {
+        SwrMixBlock *blk = &s->mix_block[b];
+
+        for (j = 0; j < blk->nb_in; j++) {
+            for (k = 0; k < SWR_MIX_BLOCK; k++) {
+                int out_i = blk->out_ch[k];
+                int in_i  = blk->in_ch[j];
+                int idx   = blk->coeff_offset + j * SWR_MIX_BLOCK + k;
+
+                switch (s->midbuf.fmt) {
+                case AV_SAMPLE_FMT_FLTP:
+                    ((float *)s->native_block_matrix)[idx]  = s->matrix_flt[out_i][in_i];
+                    break;
+                case AV_SAMPLE_FMT_DBLP:
+                    ((double *)s->native_block_matrix)[idx] = s->matrix[out_i][in_i];
+                    break;
+                default:
+                    ((int *)s->native_block_matrix)[idx]    = s->matrix32[out_i][in_i];
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
 av_cold int swri_rematrix_init(SwrContext *s){
-    int i, j;
+    int i, j, ret;
     int nb_in  = av_get_channel_layout_nb_channels(s->in_ch_layout);
     int nb_out = av_get_channel_layout_nb_channels(s->out_ch_layout);
 
@@ -421,6 +490,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_clip_s16;
             s->mix_any_f = (mix_any_func_type*)get_mix_any_func_clip_s16(s);
         }
+        s->mix_block_f = (mix_block_func_type*)mix_block_s16;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_FLTP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(float));
         s->native_one    = av_mallocz(sizeof(float));
@@ -433,6 +503,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
+        s->mix_block_f = (mix_block_func_type*)mix_block_float;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
         s->native_one    = av_mallocz(sizeof(double));
@@ -445,19 +516,20 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_double;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_double;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_double(s);
+        s->mix_block_f = (mix_block_func_type*)mix_block_double;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
-        // Only for dithering currently
-//         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
+        s->native_matrix = av_calloc(nb_in * nb_out, sizeof(int));
         s->native_one    = av_mallocz(sizeof(int));
-        if (!s->native_one)
+        if (!s->native_matrix || !s->native_one)
             return AVERROR(ENOMEM);
-//         for (i = 0; i < nb_out; i++)
-//             for (j = 0; j < nb_in; j++)
-//                 ((double*)s->native_matrix)[i * nb_in + j] = s->matrix[i][j];
+        for (i = 0; i < nb_out; i++)
+            for (j = 0; j < nb_in; j++)
+                ((int*)s->native_matrix)[i * nb_in + j] = lrintf(s->matrix[i][j] * 32768);
         *((int*)s->native_one) = 32768;
         s->mix_1_1_f = (mix_1_1_func_type*)copy_s32;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_s32;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s32(s);
+        s->mix_block_f = (mix_block_func_type*)mix_block_s32;
     }else
         av_assert0(0);
     //FIXME quantize for integeres
@@ -471,6 +543,10 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->matrix_ch[i][0]= ch_in;
     }
 
+    ret = init_mix_blocks(s);
+    if (ret < 0)
+        return ret;
+
     if(HAVE_YASM && HAVE_MMX)
         return swri_rematrix_init_x86(s);
 
@@ -482,10 +558,56 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_one);
     av_freep(&s->native_simd_matrix);
     av_freep(&s->native_simd_one);
+    av_freep(&s->native_block_matrix);
+}
+
+/**
+ * Mix the inputs of output channel out_i one output at a time.
+ */
+static void mix_output_c(SwrContext *s, AudioData *out, AudioData *in, int out_i, int len){
+    int in_i, i, j;
+
+    if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
+        for(i=0; i<len; i++){
+            float v=0;
+            for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                in_i= s->matrix_ch[out_i][1+j];
+                v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
+            }
+            ((float*)out->ch[out_i])[i]= v;
+        }
+    }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
+        for(i=0; i<len; i++){
+            double v=0;
+            for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                in_i= s->matrix_ch[out_i][1+j];
+                v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
+            }
+            ((double*)out->ch[out_i])[i]= v;
+        }
+    }else if(s->int_sample_fmt == AV_SAMPLE_FMT_S32P){
+        for(i=0; i<len; i++){
+            int64_t v=0;
+            for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                in_i= s->matrix_ch[out_i][1+j];
+                v+= ((int32_t*)in->ch[in_i])[i] * (int64_t)s->matrix32[out_i][in_i];
+            }
+            ((int32_t*)out->ch[out_i])[i]= (v + 16384)>>15;
+        }
+    }else{
+        for(i=0; i<len; i++){
+            int v=0;
+            for(j=0; j<s->matrix_ch[out_i][0]; j++){
+                in_i= s->matrix_ch[out_i][1+j];
+                v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
+            }
+            ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
+        }
+    }
 }
 
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
+    int out_i, in_i, j, b;
     int len1 = 0;
     int off = 0;
 
@@ -532,34 +654,40 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                 s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
             break;}
         default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
-                }
-            }else{
-                for(i=0; i<len; i++){
-                    int v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
-                    }
-                    ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
-                }
-            }
+            /* mixed by blocks below */
+            break;
+        }
+    }
+
+    for(b=0; b<s->nb_mix_blocks; b++){
+        const SwrMixBlock *blk = &s->mix_block[b];
+        const uint8_t *coeffp = s->native_block_matrix + blk->coeff_offset *
+                                (s->int_sample_fmt == AV_SAMPLE_FMT_DBLP ? sizeof(double) : sizeof(int));
+        uint8_t *outp[SWR_MIX_BLOCK];
+        const uint8_t *inp[SWR_CH_MAX];
+        int len2 = s->mix_block_simd ? len & ~15 : 0;
+
+        /* in C, mixing the repeated outputs of a partial block costs more
+         * than loading the inputs once saves */
+        if(!s->mix_block_simd && blk->nb_out < SWR_MIX_BLOCK){
+            for(j=0; j<blk->nb_out; j++)
+                mix_output_c(s, out, in, blk->out_ch[j], len);
+            continue;
+        }
+
+        for(j=0; j<SWR_MIX_BLOCK; j++)
+            outp[j] = out->ch[blk->out_ch[j]];
+        for(j=0; j<blk->nb_in; j++)
+            inp[j] = in->ch[blk->in_ch[j]];
+
+        if(len2)
+            s->mix_block_simd(outp, inp, coeffp, blk->nb_in, len2);
+        if(len != len2){
+            for(j=0; j<SWR_MIX_BLOCK; j++)
+                outp[j] += len2 * out->bps;
+            for(j=0; j<blk->nb_in; j++)
+                inp[j]  += len2 * out->bps;
+            s->mix_block_f(outp, inp, coeffp, blk->nb_in, len - len2);
         }
     }
     return 0;
@@ -87,6 +87,21 @@ static void RENAME(mix8to2)(SAMPLE **out, const SAMPLE **in, COEFF *coeffp, inte
     }
 }
 
+#ifndef TEMPLATE_CLIP
+static void RENAME(mix_block)(SAMPLE **out, const SAMPLE **in, COEFF *coeffp, integer nb_in, integer len){
+    int i, j, k;
+
+    for(i=0; i<len; i++) {
+        INTER v[SWR_MIX_BLOCK] = { 0 };
+        for(j=0; j<nb_in; j++)
+            for(k=0; k<SWR_MIX_BLOCK; k++)
+                v[k] += in[j][i] * (INTER)coeffp[j*SWR_MIX_BLOCK + k];
+        for(k=0; k<SWR_MIX_BLOCK; k++)
+            out[k][i] = R(v[k]);
+    }
+}
+#endif
+
 static RENAME(mix_any_func_type) *RENAME(get_mix_any_func)(SwrContext *s){
     if(   s->out_ch_layout == AV_CH_LAYOUT_STEREO && (s->in_ch_layout == AV_CH_LAYOUT_5POINT1 || s->in_ch_layout == AV_CH_LAYOUT_5POINT1_BACK)
        && s->matrix[0][2] == s->matrix[1][2] && s->matrix[0][3] == s->matrix[1][3]
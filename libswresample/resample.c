@@ -27,6 +27,8 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
 #include "resample.h"
 
 static inline double eval_poly(const double *coeff, int size, double x) {
@@ -300,11 +302,148 @@ fail:
     return ret;
 }
 
+/**
+ * Filter bank shared by all the contexts resampling with the same filter.
+ * Unused banks are kept for reuse, the least recently used ones being freed
+ * once they take more than FILTER_BANK_CACHE_SIZE bytes.
+ */
+typedef struct FilterBank {
+    struct FilterBank *next;
+    int refcount;
+    uint8_t *data;
+    size_t size;
+
+    enum AVSampleFormat format;
+    double factor;
+    int filter_length;
+    int filter_alloc;
+    int phase_count;
+    enum SwrFilterType filter_type;
+    double kaiser_beta;
+} FilterBank;
+
+#define FILTER_BANK_CACHE_SIZE (1 << 20)
+
+static FilterBank *filter_banks;    ///< most recently used first
+static AVMutex filter_bank_mutex;
+static AVOnce filter_bank_init_once = AV_ONCE_INIT;
+
+static void filter_bank_init(void)
+{
+    ff_mutex_init(&filter_bank_mutex, NULL);
+}
+
+static int filter_bank_matches(const FilterBank *b, const ResampleContext *c, int phase_count)
+{
+    return b->format        == c->format        &&
+           b->factor        == c->factor        &&
+           b->filter_length == c->filter_length &&
+           b->filter_alloc  == c->filter_alloc  &&
+           b->phase_count   == phase_count      &&
+           b->filter_type   == c->filter_type   &&
+           b->kaiser_beta   == c->kaiser_beta;
+}
+
+static void filter_bank_free(FilterBank **pb)
+{
+    FilterBank *b = *pb;
+
+    *pb = b->next;
+    av_freep(&b->data);
+    av_free(b);
+}
+
+/* free the least recently used unused banks beyond the size limit */
+static void filter_bank_trim(void)
+{
+    FilterBank **pb = &filter_banks;
+    size_t unused = 0;
+
+    while (*pb) {
+        if (!(*pb)->refcount && (unused += (*pb)->size) > FILTER_BANK_CACHE_SIZE)
+            filter_bank_free(pb);
+        else
+            pb = &(*pb)->next;
+    }
+}
+
+/**
+ * Get a filter bank for phase_count phases and the filter parameters of c,
+ * from the cache or built on a miss, and reference it from c->bank.
+ * c->bank is left untouched on failure.
+ */
+static uint8_t *filter_bank_get(ResampleContext *c, int phase_count)
+{
+    FilterBank **pb, *b;
+    int ret;
+
+    ff_thread_once(&filter_bank_init_once, filter_bank_init);
+    ff_mutex_lock(&filter_bank_mutex);
+    for (pb = &filter_banks; *pb; pb = &(*pb)->next) {
+        if (filter_bank_matches(*pb, c, phase_count)) {
+            b = *pb;
+            /* move it to the front */
+            *pb = b->next;
+            goto found;
+        }
+    }
+
+    b = av_mallocz(sizeof(*b));
+    if (!b)
+        goto fail;
+    b->format        = c->format;
+    b->factor        = c->factor;
+    b->filter_length = c->filter_length;
+    b->filter_alloc  = c->filter_alloc;
+    b->phase_count   = phase_count;
+    b->filter_type   = c->filter_type;
+    b->kaiser_beta   = c->kaiser_beta;
+    b->size          = (size_t)c->filter_alloc * (phase_count+1) * c->felem_size;
+    b->data = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
+    if (!b->data)
+        goto fail;
+    /* building while holding the lock keeps concurrent users of the same
+     * parameters from building it twice */
+    ret = build_filter(c, (void*)b->data, c->factor, c->filter_length, c->filter_alloc,
+                       phase_count, 1<<c->filter_shift, c->filter_type, c->kaiser_beta);
+    if (ret < 0)
+        goto fail;
+    memcpy(b->data + (c->filter_alloc*phase_count+1)*c->felem_size, b->data, (c->filter_alloc-1)*c->felem_size);
+    memcpy(b->data + (c->filter_alloc*phase_count  )*c->felem_size, b->data + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+
+found:
+    b->next     = filter_banks;
+    filter_banks = b;
+    b->refcount++;
+    ff_mutex_unlock(&filter_bank_mutex);
+
+    c->bank = b;
+    return b->data;
+fail:
+    if (b)
+        av_freep(&b->data);
+    av_free(b);
+    ff_mutex_unlock(&filter_bank_mutex);
+    return NULL;
+}
+
+static void filter_bank_release(FilterBank *b)
+{
+    if (!b)
+        return;
+
+    ff_mutex_lock(&filter_bank_mutex);
+    av_assert0(b->refcount > 0);
+    b->refcount--;
+    filter_bank_trim();
+    ff_mutex_unlock(&filter_bank_mutex);
+}
+
 static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
-    av_freep(&c->filter_bank);
+    filter_bank_release(c->bank);
     av_freep(cc);
 }
 
@@ -365,16 +504,12 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->factor        = factor;
         c->filter_length = FFMAX((int)ceil(filter_size/factor), 1);
         c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
         c->phase_count_compensation = phase_count_compensation;
+        c->filter_bank   = filter_bank_get(c, phase_count);
         if (!c->filter_bank)
             goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
-            goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
     }
 
     c->compensation_distance= 0;
@@ -395,7 +530,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     return c;
 error:
-    av_freep(&c->filter_bank);
+    filter_bank_release(c->bank);
     av_free(c);
     return NULL;
 }
@@ -403,34 +538,22 @@ error:
 static int rebuild_filter_bank_with_compensation(ResampleContext *c)
 {
     uint8_t *new_filter_bank;
+    FilterBank *old_bank = c->bank;
     int new_src_incr, new_dst_incr;
     int phase_count = c->phase_count_compensation;
-    int ret;
 
     if (phase_count == c->phase_count)
         return 0;
 
     av_assert0(!c->frac && !c->dst_incr_mod && !c->compensation_distance);
 
-    new_filter_bank = av_calloc(c->filter_alloc, (phase_count + 1) * c->felem_size);
-    if (!new_filter_bank)
-        return AVERROR(ENOMEM);
-
-    ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
-                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
-    if (ret < 0) {
-        av_freep(&new_filter_bank);
-        return ret;
-    }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
-
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
                    c->dst_incr * (int64_t)(phase_count/c->phase_count), INT32_MAX/2))
-    {
-        av_freep(&new_filter_bank);
         return AVERROR(EINVAL);
-    }
+
+    new_filter_bank = filter_bank_get(c, phase_count);
+    if (!new_filter_bank)
+        return AVERROR(ENOMEM);
 
     c->src_incr = new_src_incr;
     c->dst_incr = new_dst_incr;
@@ -443,7 +566,8 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
     c->index         *= phase_count / c->phase_count;
     c->phase_count    = phase_count;
-    av_freep(&c->filter_bank);
+
+    filter_bank_release(old_bank);
     c->filter_bank = new_filter_bank;
     return 0;
 }
@@ -507,23 +631,72 @@ static int swri_resample(ResampleContext *c,
     return dst_size;
 }
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+typedef struct ResampleJob {
+    ResampleContext *c;
+    ResampleContext state;      ///< copy of *c read by all channels but the last one
+    AudioData *dst, *src;
+    int dst_size, src_size;
+    int need_emms;
+    int ret, consumed;
+} ResampleJob;
+
+static void resample_channels(void *arg, int jobnr, int nb_jobs)
+{
+    ResampleJob *job = arg;
+    int ch_count = job->dst->ch_count;
+    int start    = (ch_count *  jobnr     ) / nb_jobs;
+    int end      = (ch_count * (jobnr + 1)) / nb_jobs;
+    int i, consumed;
+
+    for (i = start; i < end; i++) {
+        /* only the last channel updates the context, which the others
+         * must not see before they are done */
+        if (i + 1 == ch_count)
+            job->ret = swri_resample(job->c, job->dst->ch[i], job->src->ch[i],
+                                     &job->consumed, job->src_size, job->dst_size, 1);
+        else
+            swri_resample(&job->state, job->dst->ch[i], job->src->ch[i],
+                          &consumed, job->src_size, job->dst_size, 0);
+    }
+    if (job->need_emms)
+        emms_c();
+}
+
+static int multiple_resample(SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+    ResampleContext *c = s->resample;
     int i, ret= -1;
     int av_unused mm_flags = av_get_cpu_flags();
     int need_emms = c->format == AV_SAMPLE_FMT_S16P && ARCH_X86_32 &&
                     (mm_flags & (AV_CPU_FLAG_MMX2 | AV_CPU_FLAG_SSE2)) == AV_CPU_FLAG_MMX2;
     int64_t max_src_size = (INT64_MAX/2 / c->phase_count) / c->src_incr;
+    int nb_jobs = s->thread ? FFMIN(s->nb_threads, dst->ch_count) : 1;
 
     if (c->compensation_distance)
         dst_size = FFMIN(dst_size, c->compensation_distance);
     src_size = FFMIN(src_size, max_src_size);
 
-    for(i=0; i<dst->ch_count; i++){
-        ret= swri_resample(c, dst->ch[i], src->ch[i],
-                           consumed, src_size, dst_size, i+1==dst->ch_count);
+    if (nb_jobs > 1) {
+        ResampleJob job = {
+            .c         = c,
+            .state     = *c,
+            .dst       = dst,
+            .src       = src,
+            .dst_size  = dst_size,
+            .src_size  = src_size,
+            .need_emms = need_emms,
+        };
+
+        avpriv_slicethread_execute(s->thread, resample_channels, &job, nb_jobs);
+        ret       = job.ret;
+        *consumed = job.consumed;
+    } else {
+        for(i=0; i<dst->ch_count; i++){
+            ret= swri_resample(c, dst->ch[i], src->ch[i],
+                               consumed, src_size, dst_size, i+1==dst->ch_count);
+        }
+        if(need_emms)
+            emms_c();
     }
-    if(need_emms)
-        emms_c();
 
     if (c->compensation_distance) {
         c->compensation_distance -= ret;
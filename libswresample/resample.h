@@ -49,6 +49,7 @@ typedef struct ResampleContext {
     int felem_size;
     int filter_shift;
     int phase_count_compensation;      /* desired phase_count when compensation is enabled */
+    struct FilterBank *bank;           ///< shared cache entry holding filter_bank
 
     struct {
         void (*resample_one)(void *dst, const void *src,
@@ -23,7 +23,9 @@
 #include "audioconvert.h"
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/cpu.h"
 #include "libavutil/internal.h"
+#include "libavutil/slicethread.h"
 
 #include <float.h>
 
@@ -132,6 +134,7 @@ static void clear_context(SwrContext *s){
     swri_audio_convert_free(&s->out_convert);
     swri_audio_convert_free(&s->full_convert);
     swri_rematrix_free(s);
+    avpriv_slicethread_free(&s->thread);
 
     s->delayed_samples_fixup = 0;
     s->flushed = 0;
@@ -368,6 +371,22 @@ av_assert0(s->out.ch_count);
         set_audiodata_fmt(&s->in_buffer, s->int_sample_fmt);
     }
 
+    if (s->resample && s->engine == SWR_ENGINE_SWR && s->threads != 1) {
+        /* one group of channels per thread at most */
+        int nb_threads = FFMIN(s->threads ? s->threads : av_cpu_count(),
+                               s->in_buffer.ch_count);
+
+        if (nb_threads > 1) {
+            ret = avpriv_slicethread_create(&s->thread, nb_threads);
+            if (ret < 0 && ret != AVERROR(ENOSYS))
+                goto fail;
+            if (ret > 1) {
+                s->nb_threads = ret;
+                av_log(s, AV_LOG_VERBOSE, "Using %d resampling threads\n", ret);
+            }
+        }
+    }
+
     av_assert0(!s->preout.count);
     s->dither.noise = s->preout;
     s->dither.temp  = s->preout;
@@ -507,7 +526,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &tmp, s->in_buffer_count, &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -527,7 +546,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -42,6 +42,22 @@ typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, vo
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
+#define SWR_MIX_BLOCK 4 ///< number of output channels mixed per pass over the input
+
+/**
+ * Mix nb_in input channels into SWR_MIX_BLOCK output channels.
+ * coeffp holds SWR_MIX_BLOCK coefficients per input channel.
+ */
+typedef void (mix_block_func_type)(uint8_t **out, const uint8_t **in, const void *coeffp, integer nb_in, integer len);
+
+typedef struct SwrMixBlock {
+    uint8_t out_ch[SWR_MIX_BLOCK];  ///< output channels, the last one repeated in a partial block
+    uint8_t in_ch[SWR_CH_MAX];      ///< input channels with a nonzero coefficient for any of the outputs
+    int nb_out;                     ///< number of distinct output channels
+    int nb_in;
+    int coeff_offset;               ///< index of the first coefficient of the block in native_block_matrix
+} SwrMixBlock;
+
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
     uint8_t *data;              ///< samples buffer
@@ -71,7 +87,7 @@ struct DitherContext {
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
-typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
+typedef int     (* multiple_resample_func)(struct SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
 typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
@@ -184,6 +200,16 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    SwrMixBlock mix_block[SWR_CH_MAX / SWR_MIX_BLOCK]; ///< blocks of the output channels mixing more than 2 input channels
+    int nb_mix_blocks;
+    uint8_t *native_block_matrix;
+    mix_block_func_type *mix_block_f;
+    mix_block_func_type *mix_block_simd;
+
+    int threads;                                    ///< number of threads resampling channel groups in parallel, 0 for auto
+    struct AVSliceThread *thread;                   ///< worker pool, NULL if resampling is done on the calling thread
+    int nb_threads;                                 ///< number of threads of the worker pool
+
     /* TODO: callbacks for ASM optimizations */
 };
 
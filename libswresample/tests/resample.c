@@ -0,0 +1,102 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libswresample/resample.c"
+
+#undef printf
+
+#define NB_RATES 24
+
+static ResampleContext *open_resampler(int out_rate, int in_rate, enum AVSampleFormat format)
+{
+    ResampleContext *c = resample_init(NULL, out_rate, in_rate, 32, 10, 0, 0.97, format,
+                                       SWR_FILTER_TYPE_KAISER, 9, 20, 0, 0);
+    if (!c) {
+        printf("failed to open a %d -> %d resampler\n", in_rate, out_rate);
+        exit(1);
+    }
+    return c;
+}
+
+static void print_cache(const char *step)
+{
+    const FilterBank *b;
+    size_t unused = 0;
+    int nb_banks = 0, nb_unused = 0;
+
+    for (b = filter_banks; b; b = b->next) {
+        nb_banks++;
+        if (!b->refcount) {
+            nb_unused++;
+            unused += b->size;
+        }
+    }
+    printf("%-28s banks %2d, unused %2d, unused size %s the limit\n", step,
+           nb_banks, nb_unused, unused <= FILTER_BANK_CACHE_SIZE ? "within" : "above");
+}
+
+static int in_cache(const FilterBank *bank)
+{
+    const FilterBank *b;
+
+    for (b = filter_banks; b; b = b->next)
+        if (b == bank)
+            return 1;
+    return 0;
+}
+
+int main(void)
+{
+    ResampleContext *a, *b, *c, *d, *r[NB_RATES];
+    int i;
+
+    a = open_resampler(48000, 44100, AV_SAMPLE_FMT_S16P);
+    b = open_resampler(48000, 44100, AV_SAMPLE_FMT_S16P);
+    printf("same parameters share a bank: %s, refcount %d\n",
+           a->bank == b->bank ? "yes" : "no", a->bank->refcount);
+
+    c = open_resampler(48000, 44100, AV_SAMPLE_FMT_FLTP);
+    d = open_resampler(44100, 48000, AV_SAMPLE_FMT_S16P);
+    printf("other format shares the bank: %s\n", c->bank == a->bank ? "yes" : "no");
+    printf("other rates share the bank: %s\n",  d->bank == a->bank ? "yes" : "no");
+    print_cache("opened 4 resamplers");
+
+    resample_free(&a);
+    print_cache("closed one of the pair");
+    resample_free(&b);
+    resample_free(&c);
+    resample_free(&d);
+    print_cache("closed all");
+
+    a = open_resampler(48000, 44100, AV_SAMPLE_FMT_S16P);
+    print_cache("reopened the first one");
+
+    for (i = 0; i < NB_RATES; i++)
+        r[i] = open_resampler(8000 + 1000 * i, 44100, AV_SAMPLE_FMT_DBLP);
+    print_cache("opened other rates");
+    for (i = 0; i < NB_RATES; i++)
+        resample_free(&r[i]);
+    print_cache("closed other rates");
+    printf("bank in use still cached: %s, refcount %d\n",
+           in_cache(a->bank) ? "yes" : "no", a->bank->refcount);
+
+    resample_free(&a);
+    print_cache("closed all");
+
+    return 0;
+}
@@ -40,6 +40,7 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
 
     s->mix_1_1_simd = NULL;
     s->mix_2_1_simd = NULL;
+    s->mix_block_simd = NULL;
 
     if (s->midbuf.fmt == AV_SAMPLE_FMT_S16P){
         if(EXTERNAL_MMX(mm_flags)) {
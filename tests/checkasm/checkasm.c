@@ -89,9 +89,15 @@ static const struct {
     #if CONFIG_H264QPEL
         { "h264qpel", checkasm_check_h264qpel },
     #endif
+    #if CONFIG_HEVC_DECODER
+        { "hevc_idct", checkasm_check_hevc_idct },
+    #endif
     #if CONFIG_JPEG2000_DECODER
         { "jpeg2000dsp", checkasm_check_jpeg2000dsp },
     #endif
+    #if CONFIG_ME_CMP
+        { "me_cmp", checkasm_check_me_cmp },
+    #endif
     #if CONFIG_PIXBLOCKDSP
         { "pixblockdsp", checkasm_check_pixblockdsp },
     #endif
@@ -112,6 +118,12 @@ static const struct {
     #if CONFIG_COLORSPACE_FILTER
         { "vf_colorspace", checkasm_check_colorspace },
     #endif
+#endif
+#if CONFIG_SWRESAMPLE
+    { "sw_rematrix", checkasm_check_sw_rematrix },
+#endif
+#if CONFIG_SWSCALE
+    { "sw_scale", checkasm_check_sw_scale },
 #endif
     { NULL }
 };
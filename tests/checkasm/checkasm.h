@@ -40,8 +40,12 @@ void checkasm_check_fmtconvert(void);
 void checkasm_check_h264dsp(void);
 void checkasm_check_h264pred(void);
 void checkasm_check_h264qpel(void);
+void checkasm_check_hevc_idct(void);
 void checkasm_check_jpeg2000dsp(void);
+void checkasm_check_me_cmp(void);
 void checkasm_check_pixblockdsp(void);
+void checkasm_check_sw_rematrix(void);
+void checkasm_check_sw_scale(void);
 void checkasm_check_synth_filter(void);
 void checkasm_check_v210enc(void);
 void checkasm_check_vp9dsp(void);
@@ -0,0 +1,120 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+
+#include "libavcodec/get_bits.h"
+#include "libavcodec/hevcdsp.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+static const int bit_depths[] = { 8, 10, 12 };
+
+/* Fill the coefficients up to the last significant one (last_x, last_y) as
+ * the residual coding does, and return the matching col_limit. */
+static int randomize_coeffs(int16_t *coeffs, int size, int last_x, int last_y)
+{
+    int x, y, max_xy = FFMAX(last_x, last_y);
+    int col_limit = last_x + last_y + 4;
+
+    memset(coeffs, 0, size * size * sizeof(*coeffs));
+    for (y = 0; y < size; y++)
+        for (x = 0; x < size; x++)
+            if (x + y <= last_x + last_y && x <= (last_x | 3) && y <= (last_y | 3))
+                coeffs[y * size + x] = (int16_t)rnd();
+
+    if (max_xy < 4)
+        col_limit = FFMIN(4, col_limit);
+    else if (max_xy < 8)
+        col_limit = FFMIN(8, col_limit);
+    else if (max_xy < 12)
+        col_limit = FFMIN(24, col_limit);
+    return col_limit;
+}
+
+static void check_idct(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(int16_t, coeffs0, [32 * 32]);
+    LOCAL_ALIGNED_32(int16_t, coeffs1, [32 * 32]);
+    int i;
+
+    for (i = 2; i <= 5; i++) {
+        int size = 1 << i;
+        declare_func(void, int16_t *coeffs, int col_limit);
+
+        if (check_func(h->idct[i - 2], "hevc_idct_%dx%d_%d", size, size, bit_depth)) {
+            int j;
+
+            for (j = 0; j < 4; j++) {
+                /* the last pass covers the whole block */
+                int last_x = j == 3 ? size - 1 : rnd() % size;
+                int last_y = j == 3 ? size - 1 : rnd() % size;
+                int col_limit = randomize_coeffs(coeffs0, size, last_x, last_y);
+
+                memcpy(coeffs1, coeffs0, size * size * sizeof(*coeffs0));
+                call_ref(coeffs0, col_limit);
+                call_new(coeffs1, col_limit);
+                if (memcmp(coeffs0, coeffs1, size * size * sizeof(*coeffs0)))
+                    fail();
+            }
+            randomize_coeffs(coeffs1, size, size - 1, size - 1);
+            bench_new(coeffs1, size * 2);
+        }
+    }
+}
+
+static void check_transform_4x4_luma(HEVCDSPContext *h, int bit_depth)
+{
+    LOCAL_ALIGNED_32(int16_t, coeffs0, [4 * 4]);
+    LOCAL_ALIGNED_32(int16_t, coeffs1, [4 * 4]);
+    declare_func(void, int16_t *coeffs);
+
+    if (check_func(h->idct_4x4_luma, "hevc_transform_4x4_luma_%d", bit_depth)) {
+        randomize_coeffs(coeffs0, 4, 3, 3);
+        memcpy(coeffs1, coeffs0, sizeof(*coeffs0) * 4 * 4);
+        call_ref(coeffs0);
+        call_new(coeffs1);
+        if (memcmp(coeffs0, coeffs1, sizeof(*coeffs0) * 4 * 4))
+            fail();
+        bench_new(coeffs1);
+    }
+}
+
+void checkasm_check_hevc_idct(void)
+{
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_idct(&h, bit_depths[i]);
+    }
+    report("idct");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depths[i]);
+        check_transform_4x4_luma(&h, bit_depths[i]);
+    }
+    report("transform_4x4_luma");
+}
@@ -0,0 +1,77 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+
+#include "libavcodec/me_cmp.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define STRIDE   64
+#define HEIGHT   48
+#define BUF_SIZE (STRIDE * HEIGHT)
+
+static void check_cmp_x4(me_cmp_x4_func func, const char *name)
+{
+    LOCAL_ALIGNED_16(uint8_t, src, [16 * STRIDE]);
+    LOCAL_ALIGNED_16(uint8_t, ref, [BUF_SIZE]);
+    int i, j, h;
+
+    declare_func(void, struct MpegEncContext *c, uint8_t *blk1,
+                 uint8_t *const cand[4], ptrdiff_t stride, int h,
+                 int scores[4]);
+
+    for (h = 8; h <= 16; h += 8) {
+        if (check_func(func, "%s_%d", name, h)) {
+            uint8_t *cand[4];
+            int scores0[4], scores1[4];
+
+            for (i = 0; i < 4; i++) {
+                /* the last pass uses the extreme values */
+                for (j = 0; j < 16 * STRIDE; j++)
+                    src[j] = i == 3 ? (rnd() & 1) * 255 : rnd();
+                for (j = 0; j < BUF_SIZE; j++)
+                    ref[j] = i == 3 ? (rnd() & 1) * 255 : rnd();
+                for (j = 0; j < 4; j++)
+                    cand[j] = ref + rnd() % (STRIDE - 16) +
+                              rnd() % (HEIGHT - h) * STRIDE;
+
+                call_ref(NULL, src, cand, STRIDE, h, scores0);
+                call_new(NULL, src, cand, STRIDE, h, scores1);
+                if (memcmp(scores0, scores1, sizeof(scores0)))
+                    fail();
+            }
+            bench_new(NULL, src, cand, STRIDE, h, scores1);
+        }
+    }
+}
+
+void checkasm_check_me_cmp(void)
+{
+    AVCodecContext avctx = { 0 };
+    MECmpContext c;
+
+    memset(&c, 0, sizeof(c));
+    ff_me_cmp_init(&c, &avctx);
+
+    check_cmp_x4(c.sad_x4[0], "sad16_x4");
+    report("sad_x4");
+}
@@ -0,0 +1,130 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+
+#define NB_IN   16
+#define NB_OUT  8
+#define SAMPLES 256
+
+static struct SwrContext *get_context(enum AVSampleFormat fmt)
+{
+    struct SwrContext *s;
+    double matrix[NB_OUT][NB_IN] = { { 0 } };
+    int i, j;
+
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_7POINT1, fmt, 48000,
+                           AV_CH_LAYOUT_HEXADECAGONAL, fmt, 48000, 0, NULL);
+    if (!s)
+        return NULL;
+    av_opt_set_sample_fmt(s, "internal_sample_fmt", fmt, 0);
+
+    /* a sparse matrix, so that the blocks do not use all the inputs */
+    for (i = 0; i < NB_OUT; i++)
+        for (j = 0; j < NB_IN; j++)
+            if ((i + j) % 3)
+                matrix[i][j] = (int)(rnd() % 2048 - 1024) / 4096.0;
+
+    if (swr_set_matrix(s, matrix[0], NB_IN) < 0 || swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static void check_mix_block(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [NB_IN * SAMPLES * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [SWR_MIX_BLOCK * SAMPLES * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [SWR_MIX_BLOCK * SAMPLES * 4]);
+    static const struct {
+        enum AVSampleFormat fmt;
+        const char *name;
+    } fmts[] = {
+        { AV_SAMPLE_FMT_S16P, "int16" },
+        { AV_SAMPLE_FMT_S32P, "int32" },
+        { AV_SAMPLE_FMT_FLTP, "float" },
+    };
+    int i, j;
+
+    declare_func(void, uint8_t **out, const uint8_t **in, const void *coeffp,
+                 integer nb_in, integer len);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        struct SwrContext *s = get_context(fmts[i].fmt);
+        int bps = av_get_bytes_per_sample(fmts[i].fmt);
+        const uint8_t *inp[SWR_CH_MAX];
+        uint8_t *outp0[SWR_MIX_BLOCK], *outp1[SWR_MIX_BLOCK];
+
+        if (!s) {
+            fail();
+            continue;
+        }
+
+        for (j = 0; j < NB_IN * SAMPLES; j++) {
+            switch (fmts[i].fmt) {
+            case AV_SAMPLE_FMT_S16P: ((int16_t *)src)[j] = rnd();                    break;
+            case AV_SAMPLE_FMT_S32P: ((int32_t *)src)[j] = rnd();                    break;
+            default:                 ((float *)src)[j]   = (int)rnd() / (float)INT_MAX;
+            }
+        }
+        for (j = 0; j < SWR_MIX_BLOCK; j++) {
+            outp0[j] = dst0 + j * SAMPLES * bps;
+            outp1[j] = dst1 + j * SAMPLES * bps;
+        }
+
+        /* all the blocks use the same kernel, check the first one */
+        if (s->nb_mix_blocks) {
+            const SwrMixBlock *blk = &s->mix_block[0];
+            const uint8_t *coeffp  = s->native_block_matrix;
+
+            for (j = 0; j < blk->nb_in; j++)
+                inp[j] = src + blk->in_ch[j] * SAMPLES * bps;
+
+            if (check_func(s->mix_block_simd ? s->mix_block_simd : s->mix_block_f,
+                           "mix_block_%s", fmts[i].name)) {
+                memset(dst0, 0, SWR_MIX_BLOCK * SAMPLES * bps);
+                memset(dst1, 0, SWR_MIX_BLOCK * SAMPLES * bps);
+                call_ref(outp0, inp, coeffp, blk->nb_in, SAMPLES);
+                call_new(outp1, inp, coeffp, blk->nb_in, SAMPLES);
+                if (memcmp(dst0, dst1, SWR_MIX_BLOCK * SAMPLES * bps))
+                    fail();
+                bench_new(outp1, inp, coeffp, blk->nb_in, SAMPLES);
+            }
+        } else {
+            fail();
+        }
+        swr_free(&s);
+    }
+    report("mix_block");
+}
+
+void checkasm_check_sw_rematrix(void)
+{
+    check_mix_block();
+}
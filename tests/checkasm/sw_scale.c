@@ -0,0 +1,247 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define SRC_PIXELS 512
+#define DST_PIXELS 256
+/* the SIMD versions may read and write up to 32 bytes past the line */
+#define PADDING    64
+
+#define MAX_VFILTER_SIZE 16
+
+static struct SwsContext *get_context(enum AVPixelFormat src_fmt,
+                                      enum AVPixelFormat dst_fmt)
+{
+    /* SWS_ACCURATE_RND keeps the inline MMX vertical scaler, which uses a
+     * different filter layout, out of the way */
+    return sws_getContext(SRC_PIXELS, 16, src_fmt, DST_PIXELS, 8, dst_fmt,
+                          SWS_BICUBIC | SWS_ACCURATE_RND, NULL, NULL, NULL);
+}
+
+static void check_hscale(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [SRC_PIXELS + PADDING]);
+    LOCAL_ALIGNED_32(int16_t, filter, [DST_PIXELS * 8]);
+    LOCAL_ALIGNED_32(int32_t, filter_pos, [DST_PIXELS]);
+    LOCAL_ALIGNED_32(int32_t, dst0, [DST_PIXELS + PADDING]);
+    LOCAL_ALIGNED_32(int32_t, dst1, [DST_PIXELS + PADDING]);
+    static const enum AVPixelFormat dst_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P16LE
+    };
+    static const int filter_sizes[] = { 4, 8 };
+    int i, j, k;
+
+    declare_func(void, struct SwsContext *c, int16_t *dst, int dstW,
+                 const uint8_t *src, const int16_t *filter,
+                 const int32_t *filterPos, int filterSize);
+
+    for (i = 0; i < SRC_PIXELS + PADDING; i++)
+        src[i] = rnd();
+
+    for (i = 0; i < FF_ARRAY_ELEMS(dst_fmts); i++) {
+        struct SwsContext *c = get_context(AV_PIX_FMT_YUV420P, dst_fmts[i]);
+        int to;
+
+        if (!c) {
+            fail();
+            continue;
+        }
+        to = c->dstBpc > 14 ? 19 : 15;
+
+        for (j = 0; j < FF_ARRAY_ELEMS(filter_sizes); j++) {
+            int filter_size = filter_sizes[j];
+
+            /* keep the negative taps small enough for the C clipping
+             * (which only clips positive overflows) to match pack/min */
+            for (k = 0; k < DST_PIXELS * filter_size; k++)
+                filter[k] = rnd() % 5120 - 1024;
+            for (k = 0; k < DST_PIXELS; k++)
+                filter_pos[k] = rnd() % (SRC_PIXELS - filter_size + 1);
+
+            c->hLumFilterSize = filter_size;
+            ff_getSwsFunc(c);
+
+            if (check_func(c->hyScale, "hscale_8_to_%d_%d", to, filter_size)) {
+                memset(dst0, 0, (DST_PIXELS + PADDING) * sizeof(*dst0));
+                memset(dst1, 0, (DST_PIXELS + PADDING) * sizeof(*dst1));
+
+                call_ref(c, (int16_t *)dst0, DST_PIXELS, src, filter,
+                         filter_pos, filter_size);
+                call_new(c, (int16_t *)dst1, DST_PIXELS, src, filter,
+                         filter_pos, filter_size);
+                if (memcmp(dst0, dst1, DST_PIXELS * (to == 19 ? 4 : 2)))
+                    fail();
+                bench_new(c, (int16_t *)dst1, DST_PIXELS, src, filter,
+                          filter_pos, filter_size);
+            }
+        }
+        sws_freeContext(c);
+    }
+    report("hscale");
+}
+
+static void check_yuv2planeX(void)
+{
+    LOCAL_ALIGNED_32(int32_t, src_lines, [MAX_VFILTER_SIZE * (DST_PIXELS + PADDING)]);
+    LOCAL_ALIGNED_32(int16_t, filter, [MAX_VFILTER_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [(DST_PIXELS + PADDING) * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [(DST_PIXELS + PADDING) * 2]);
+    const int16_t *src[MAX_VFILTER_SIZE];
+    uint8_t dither[8];
+    static const enum AVPixelFormat dst_fmts[] = {
+        AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P9LE,
+        AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P16LE,
+    };
+    int i, j, k;
+
+    declare_func(void, const int16_t *filter, int filterSize,
+                 const int16_t **src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    for (i = 0; i < MAX_VFILTER_SIZE; i++)
+        src[i] = (const int16_t *)(src_lines + i * (DST_PIXELS + PADDING));
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd();
+
+    for (i = 0; i < FF_ARRAY_ELEMS(dst_fmts); i++) {
+        struct SwsContext *c = get_context(AV_PIX_FMT_YUV420P, dst_fmts[i]);
+        int bits, bpp;
+
+        if (!c) {
+            fail();
+            continue;
+        }
+        bits = c->dstBpc;
+        bpp  = bits > 8 ? 2 : 1;
+
+        /* the intermediate is 15 bits in int16_t, or 19 bits in int32_t */
+        for (j = 0; j < MAX_VFILTER_SIZE; j++) {
+            int32_t *line32 = (int32_t *)src[j];
+            int16_t *line16 = (int16_t *)src[j];
+
+            for (k = 0; k < DST_PIXELS + PADDING; k++) {
+                if (bits == 16)
+                    line32[k] = rnd() & 0x7ffff;
+                else
+                    line16[k] = rnd() & 0x7fff;
+            }
+        }
+
+        if (check_func(c->yuv2planeX, "yuv2planeX_%d", bits)) {
+            for (j = 0; j < 4; j++) {
+                int filter_size = 2 * (1 + rnd() % (MAX_VFILTER_SIZE / 2));
+                int offset      = j & 1 ? 3 : 0;
+
+                for (k = 0; k < filter_size; k++)
+                    filter[k] = rnd() % 4096 - 2048;
+
+                memset(dst0, 0, (DST_PIXELS + PADDING) * 2);
+                memset(dst1, 0, (DST_PIXELS + PADDING) * 2);
+                call_ref(filter, filter_size, src, dst0, DST_PIXELS, dither, offset);
+                call_new(filter, filter_size, src, dst1, DST_PIXELS, dither, offset);
+                if (memcmp(dst0, dst1, DST_PIXELS * bpp))
+                    fail();
+            }
+            bench_new(filter, MAX_VFILTER_SIZE, src, dst1, DST_PIXELS, dither, 0);
+        }
+        sws_freeContext(c);
+    }
+    report("yuv2planeX");
+}
+
+static void check_input(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [SRC_PIXELS * 2 + PADDING]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [(SRC_PIXELS + PADDING) * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [(SRC_PIXELS + PADDING) * 2]);
+    static const enum AVPixelFormat src_fmts[] = {
+        AV_PIX_FMT_YUYV422, AV_PIX_FMT_UYVY422,
+        AV_PIX_FMT_NV12,    AV_PIX_FMT_NV21,
+    };
+    /* not a multiple of the vector size, to check the tail handling */
+    const int width = SRC_PIXELS / 2 - 7;
+    int i;
+
+    for (i = 0; i < SRC_PIXELS * 2 + PADDING; i++)
+        src[i] = rnd();
+
+    for (i = 0; i < FF_ARRAY_ELEMS(src_fmts); i++) {
+        struct SwsContext *c = get_context(src_fmts[i], AV_PIX_FMT_YUV420P);
+        const char *name = av_get_pix_fmt_name(src_fmts[i]);
+
+        if (!c) {
+            fail();
+            continue;
+        }
+
+        if (c->lumToYV12) {
+            declare_func(void, uint8_t *dst, const uint8_t *src,
+                         const uint8_t *src2, const uint8_t *src3,
+                         int width, uint32_t *pal);
+
+            if (check_func(c->lumToYV12, "%s_to_y", name)) {
+                memset(dst0, 0, SRC_PIXELS + PADDING);
+                memset(dst1, 0, SRC_PIXELS + PADDING);
+                call_ref(dst0, src, src, src, width, NULL);
+                call_new(dst1, src, src, src, width, NULL);
+                if (memcmp(dst0, dst1, width))
+                    fail();
+                bench_new(dst1, src, src, src, width, NULL);
+            }
+        }
+
+        if (c->chrToYV12) {
+            declare_func(void, uint8_t *dstU, uint8_t *dstV,
+                         const uint8_t *src1, const uint8_t *src2,
+                         const uint8_t *src3, int width, uint32_t *pal);
+
+            if (check_func(c->chrToYV12, "%s_to_uv", name)) {
+                uint8_t *dst0v = dst0 + SRC_PIXELS + PADDING;
+                uint8_t *dst1v = dst1 + SRC_PIXELS + PADDING;
+
+                memset(dst0, 0, (SRC_PIXELS + PADDING) * 2);
+                memset(dst1, 0, (SRC_PIXELS + PADDING) * 2);
+                call_ref(dst0, dst0v, src, src, src, width, NULL);
+                call_new(dst1, dst1v, src, src, src, width, NULL);
+                if (memcmp(dst0, dst1, width) || memcmp(dst0v, dst1v, width))
+                    fail();
+                bench_new(dst1, dst1v, src, src, src, width, NULL);
+            }
+        }
+        sws_freeContext(c);
+    }
+    report("input");
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_hscale();
+    check_yuv2planeX();
+    check_input();
+}
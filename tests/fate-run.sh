@@ -96,6 +96,15 @@ probeframes(){
     run ffprobe${PROGSUF} -show_frames -v 0 "$@"
 }
 
+probethreads(){
+    serialfile="${outdir}/${test}.serial"
+    cleanfiles="$cleanfiles $serialfile"
+    run ffprobe${PROGSUF} -bitexact -of compact -show_packets -show_streams -v 0 "$@" > $serialfile || return
+    run ffprobe${PROGSUF} -bitexact -of compact -show_packets -show_streams -v 0 -probe_threads 4 "$@" |
+        diff $serialfile - || return
+    cat $serialfile
+}
+
 probechapters(){
     run ffprobe${PROGSUF} -show_chapters -v 0 "$@"
 }
@@ -210,6 +219,42 @@ transcode(){
         -f framecrc - || return
 }
 
+chunked(){
+    srcfile=$1
+    enc_opt=$2
+    encfile="${outdir}/${test}.mkv"
+    serialfile="${outdir}/${test}.serial"
+    chunkedfile="${outdir}/${test}.chunked"
+    cleanfiles="$cleanfiles $encfile $serialfile $chunkedfile"
+    tsrcfile=$(target_path $srcfile)
+    tencfile=$(target_path $encfile)
+    ffmpeg -f image2 -c:v pgmyuv $DEC_OPTS -i $tsrcfile $ENC_OPTS -c:v mpeg4 -g 10 $FLAGS \
+        -f matroska -y $tencfile || return
+    ffmpeg $DEC_OPTS -i $tencfile $ENC_OPTS $enc_opt $FLAGS \
+        -f framecrc - > $serialfile || return
+    ffmpeg $DEC_OPTS -i $tencfile $ENC_OPTS $enc_opt $FLAGS -chunk_threads 2 \
+        -f framecrc - > $chunkedfile || return
+    # the chunks are encoded separately, so only the timestamps must match
+    cut -d, -f3 $serialfile  | grep -v '^#' | sort -n > $serialfile.pts
+    cut -d, -f3 $chunkedfile | grep -v '^#' | sort -n > $chunkedfile.pts
+    cleanfiles="$cleanfiles $serialfile.pts $chunkedfile.pts"
+    diff $serialfile.pts $chunkedfile.pts || return
+    grep -v '^#' $chunkedfile | awk -F, 'NR > 1 && $2 <= dts || $2 > $3 { print "bad dts: " $0; exit 1 }
+                                        { dts = $2 + 0; print $1 "," $2 "," $3 "," $4 }'
+}
+
+seekindex(){
+    seekprog=$1
+    srcfile=$2
+    indexfile="${outdir}/${test}.index"
+    cleanfiles="$cleanfiles $indexfile"
+    tindexfile=$(target_path $indexfile)
+    rm -f $indexfile
+    run ffprobe${PROGSUF} -v 0 -show_packets -seek_index $tindexfile $srcfile > /dev/null || return
+    test -s $indexfile || return
+    run $seekprog $srcfile -seek_index $tindexfile
+}
+
 lavffatetest(){
     t="${test#lavf-fate-}"
     ref=${base}/ref/lavf-fate/$t
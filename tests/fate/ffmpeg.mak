@@ -25,6 +25,10 @@ fate-ffmpeg-filter_colorkey: CMD = framecrc -idct simple -fflags +bitexact -flag
 FATE_FFMPEG-$(CONFIG_COLOR_FILTER) += fate-ffmpeg-lavfi
 fate-ffmpeg-lavfi: CMD = framecrc -lavfi color=d=1:r=5 -fflags +bitexact
 
+FATE_FFMPEG-$(call ALLYES, IMAGE2_DEMUXER PGMYUV_DECODER MPEG4_ENCODER MPEG4_DECODER MATROSKA_MUXER MATROSKA_DEMUXER FRAMECRC_MUXER) += fate-ffmpeg-chunk_threads
+fate-ffmpeg-chunk_threads: $(VREF)
+fate-ffmpeg-chunk_threads: CMD = chunked tests/vsynth1/%02d.pgm "-c:v mpeg4 -bf 2 -qscale 10"
+
 FATE_SAMPLES_FFMPEG-$(CONFIG_RAWVIDEO_DEMUXER) += fate-force_key_frames
 fate-force_key_frames: tests/data/vsynth_lena.yuv
 fate-force_key_frames: CMD = enc_dec \
@@ -29,7 +29,23 @@ FATE_FFPROBE-$(CONFIG_AVDEVICE) += fate-ffprobe_xml
 fate-ffprobe_xml: $(FFPROBE_TEST_FILE)
 fate-ffprobe_xml: CMD = run $(FFPROBE_COMMAND) -of xml
 
+FATE_FFPROBE-$(call DEMDEC, MPEGTS, MPEG2VIDEO MP2) += fate-ffprobe_threads-ts
+fate-ffprobe_threads-ts: fate-lavf-ts
+fate-ffprobe_threads-ts: CMD = probethreads $(TARGET_PATH)/tests/data/lavf/lavf.ts
+
+FATE_FFPROBE-$(call DEMDEC, MATROSKA, MPEG4 MP2) += fate-ffprobe_threads-mkv
+fate-ffprobe_threads-mkv: fate-lavf-mkv
+fate-ffprobe_threads-mkv: CMD = probethreads $(TARGET_PATH)/tests/data/lavf/lavf.mkv
+
+# H.264 with B-frames, whose reorder delay is only known once frames have
+# been decoded; the threaded probe must time the packets like the serial one.
+FATE_SAMPLES_FFPROBE-$(call DEMDEC, MATROSKA, H264) += fate-ffprobe_threads-h264
+fate-ffprobe_threads-h264: CMD = probethreads $(TARGET_SAMPLES)/h264/direct-bff.mkv
+fate-ffprobe_threads-h264: CMP = null
+fate-ffprobe_threads-h264: REF = /dev/null
+
 FATE_FFPROBE += $(FATE_FFPROBE-yes)
+FATE_SAMPLES_FFPROBE += $(FATE_SAMPLES_FFPROBE-yes)
 
 fate-ffprobe: $(FATE_FFPROBE)
 
@@ -68,6 +68,11 @@ fate-filter-alimiter: tests/data/asynth-44100-2.wav
 fate-filter-alimiter: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
 fate-filter-alimiter: CMD = framecrc -i $(SRC) -af alimiter=level_in=1:level_out=2:limit=0.2
 
+FATE_AFILTER-$(call ALLYES, WAV_DEMUXER PCM_S16LE_DECODER PCM_S16LE_ENCODER FRAMECRC_MUXER VOLUME_FILTER ANULL_FILTER AFORMAT_FILTER) += fate-filter-fused-chain
+fate-filter-fused-chain: tests/data/asynth-44100-2.wav
+fate-filter-fused-chain: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
+fate-filter-fused-chain: CMD = framecrc -i $(SRC) -af volume=precision=fixed:volume=0.5,anull,aformat=sample_fmts=s16,anull,volume=precision=fixed:volume=1.5
+
 FATE_AFILTER-$(call FILTERDEMDECENCMUX, AMERGE, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-filter-amerge
 fate-filter-amerge: tests/data/asynth-44100-1.wav
 fate-filter-amerge: SRC = $(TARGET_PATH)/tests/data/asynth-44100-1.wav
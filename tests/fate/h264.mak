@@ -213,6 +213,20 @@ FATE_H264-$(call DEMDEC, MOV, H264) += fate-h264-attachment-631
 FATE_H264-$(call DEMDEC, MPEGTS, H264) += fate-h264-skip-nokey fate-h264-skip-nointra
 FATE_H264_FFPROBE-$(call DEMDEC, MATROSKA, H264) += fate-h264-dts_5frames
 
+# the deblocking pipeline must give the same output as the conformance tests
+FATE_H264_DEBLOCK_PIPELINE = caba1_sony_d                                 \
+                             cama1_sony_c                                 \
+                             canl1_toshiba_g                              \
+                             frext-hpcv_brcm_a                            \
+                             sva_ba1_b                                    \
+
+FATE_H264_DEBLOCK_PIPELINE := $(FATE_H264_DEBLOCK_PIPELINE:%=fate-h264-deblock-pipeline-%)
+FATE_H264-$(call DEMDEC, H264, H264) += $(FATE_H264_DEBLOCK_PIPELINE)
+
+$(FATE_H264_DEBLOCK_PIPELINE): THREADS = 4
+$(FATE_H264_DEBLOCK_PIPELINE): THREAD_TYPE = slice
+$(FATE_H264_DEBLOCK_PIPELINE): REF = $(SRC_PATH)/tests/ref/fate/$(subst deblock-pipeline,conformance,$(@:fate-%=%))
+
 FATE_SAMPLES_AVCONV += $(FATE_H264-yes)
 FATE_SAMPLES_FFPROBE += $(FATE_H264_FFPROBE-yes)
 fate-h264: $(FATE_H264-yes) $(FATE_H264_FFPROBE-yes)
@@ -405,6 +419,12 @@ fate-h264-conformance-sva_fm1_e:                  CMD = framecrc -vsync drop -i
 fate-h264-conformance-sva_nl1_b:                  CMD = framecrc -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/SVA_NL1_B.264
 fate-h264-conformance-sva_nl2_e:                  CMD = framecrc -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/SVA_NL2_E.264
 
+fate-h264-deblock-pipeline-caba1_sony_d:           CMD = framecrc -deblock_pipeline 1 -i $(TARGET_SAMPLES)/h264-conformance/CABA1_Sony_D.jsv
+fate-h264-deblock-pipeline-cama1_sony_c:           CMD = framecrc -deblock_pipeline 1 -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/CAMA1_Sony_C.jsv
+fate-h264-deblock-pipeline-canl1_toshiba_g:        CMD = framecrc -deblock_pipeline 1 -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/CANL1_TOSHIBA_G.264
+fate-h264-deblock-pipeline-frext-hpcv_brcm_a:      CMD = framecrc -deblock_pipeline 1 -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/FRext/HPCV_BRCM_A.264
+fate-h264-deblock-pipeline-sva_ba1_b:              CMD = framecrc -deblock_pipeline 1 -vsync drop -i $(TARGET_SAMPLES)/h264-conformance/SVA_BA1_B.264
+
 fate-h264-bsf-mp4toannexb:                        CMD = md5 -i $(TARGET_SAMPLES)/h264/interlaced_crop.mp4 -vcodec copy -f h264
 
 fate-h264-crop-to-container:                      CMD = framemd5 -i $(TARGET_SAMPLES)/h264/crop-to-container-dims-canon.mov
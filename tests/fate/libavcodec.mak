@@ -3,6 +3,11 @@ fate-cabac: libavcodec/tests/cabac$(EXESUF)
 fate-cabac: CMD = run libavcodec/tests/cabac
 fate-cabac: REF = /dev/null
 
+FATE_LIBAVCODEC-$(CONFIG_GOLOMB) += fate-get_bits
+fate-get_bits: libavcodec/tests/get_bits$(EXESUF)
+fate-get_bits: CMD = run libavcodec/tests/get_bits
+fate-get_bits: REF = /dev/null
+
 FATE_LIBAVCODEC-$(CONFIG_GOLOMB) += fate-golomb
 fate-golomb: libavcodec/tests/golomb$(EXESUF)
 fate-golomb: CMD = run libavcodec/tests/golomb
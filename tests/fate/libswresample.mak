@@ -749,5 +749,23 @@ fate-swr-audioconvert: CMP = stddev
 fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
+
+FATE_SWR_THREADS-$(call FILTERDEMDECENCMUX, ARESAMPLE, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += fate-swr-resample-8ch fate-swr-resample-threads
+fate-swr-resample-8ch: tests/data/asynth-44100-8.wav
+fate-swr-resample-8ch: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-8.wav -af aresample=48000:swr_threads=1 -f s16le
+
+# the output must match the one of a single thread
+fate-swr-resample-threads: tests/data/asynth-44100-8.wav
+fate-swr-resample-threads: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-44100-8.wav -af aresample=48000:swr_threads=3 -f s16le
+fate-swr-resample-threads: REF = $(SRC_PATH)/tests/ref/fate/swr-resample-8ch
+
+FATE_SWR += $(FATE_SWR_THREADS-yes)
 FATE_FFMPEG += $(FATE_SWR)
 fate-swr: $(FATE_SWR)
+
+FATE_LIBSWRESAMPLE += fate-swr-filter-bank-cache
+fate-swr-filter-bank-cache: libswresample/tests/resample$(EXESUF)
+fate-swr-filter-bank-cache: CMD = run libswresample/tests/resample
+
+FATE-$(CONFIG_SWRESAMPLE) += $(FATE_LIBSWRESAMPLE)
+fate-libswresample: $(FATE_LIBSWRESAMPLE)
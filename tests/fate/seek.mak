@@ -254,12 +254,21 @@ fate-seek-mkv-codec-delay:   CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_
 
 FATE_SEEK_EXTRA += $(FATE_SEEK_EXTRA-yes)
 
+# seeks with a sidecar index written by a first read of the file
+
+FATE_SEEK_INDEX-$(call ALLYES, MPEGTS_DEMUXER FFPROBE) += fate-seek-index-ts
+fate-seek-index-ts: fate-lavf-ts
+fate-seek-index-ts: CMD = seekindex libavformat/tests/seek$(EXESUF) $(TARGET_PATH)/tests/data/lavf/lavf.ts
+
+FATE_SEEK_INDEX += $(FATE_SEEK_INDEX-yes)
+$(FATE_SEEK_INDEX): libavformat/tests/seek$(EXESUF) ffprobe$(PROGSSUF)$(EXESUF)
+
 
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA): libavformat/tests/seek$(EXESUF)
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK): CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_PATH)/tests/data/$(SRC)
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK): fate-seek-%: fate-%
 fate-seek-%: REF = $(SRC_PATH)/tests/ref/seek/$(@:fate-seek-%=%)
 
-FATE_AVCONV += $(FATE_SEEK)
+FATE_AVCONV += $(FATE_SEEK) $(FATE_SEEK_INDEX)
 FATE_SAMPLES_AVCONV += $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
-fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
+fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA) $(FATE_SEEK_INDEX)